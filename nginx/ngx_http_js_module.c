@@ -49,6 +49,27 @@ typedef struct {
 } ngx_http_js_event_t;
 
 
+/*
+ * A compiled VM is kept while any configuration cycle uses it, and it is
+ * reused on reload if the included file has the same name, size and
+ * checksum, so an unchanged script is not compiled again.  The file is
+ * not even read if its modification time and inode are not changed.
+ */
+
+typedef struct {
+    ngx_queue_t          queue;
+    ngx_uint_t           count;
+    ngx_str_t            file;
+    size_t               size;
+    time_t               mtime;
+    ngx_file_uniq_t      uniq;
+    uint32_t             crc32;
+    njs_vm_t            *vm;
+    const njs_extern_t  *req_proto;
+    const njs_extern_t  *res_proto;
+} ngx_http_js_cache_t;
+
+
 static ngx_int_t ngx_http_js_content_handler(ngx_http_request_t *r);
 static void ngx_http_js_content_event_handler(ngx_http_request_t *r);
 static void ngx_http_js_content_write_event_handler(ngx_http_request_t *r);
@@ -59,6 +80,8 @@ static ngx_int_t ngx_http_js_variable(ngx_http_request_t *r,
 static ngx_int_t ngx_http_js_init_vm(ngx_http_request_t *r);
 static void ngx_http_js_cleanup_ctx(void *data);
 static void ngx_http_js_cleanup_vm(void *data);
+static ngx_http_js_cache_t *ngx_http_js_cache_lookup(ngx_str_t *file,
+    ngx_file_info_t *fi, uint32_t *crc32);
 
 static njs_ret_t ngx_http_js_ext_get_string(njs_vm_t *vm, njs_value_t *value,
     void *obj, uintptr_t data);
@@ -637,6 +660,9 @@ static njs_external_t  ngx_http_js_externals[] = {
 };
 
 
+static ngx_queue_t  ngx_http_js_cache;
+
+
 static njs_vm_ops_t ngx_http_js_ops = {
     ngx_http_js_set_timer,
     ngx_http_js_clear_timer
@@ -954,9 +980,69 @@ ngx_http_js_cleanup_ctx(void *data)
 static void
 ngx_http_js_cleanup_vm(void *data)
 {
-    njs_vm_t *vm = data;
+    ngx_http_js_cache_t *cache = data;
 
-    njs_vm_destroy(vm);
+    if (--cache->count != 0) {
+        return;
+    }
+
+    ngx_queue_remove(&cache->queue);
+
+    if (cache->vm != NULL) {
+        njs_vm_destroy(cache->vm);
+    }
+
+    ngx_free(cache);
+}
+
+
+static ngx_http_js_cache_t *
+ngx_http_js_cache_lookup(ngx_str_t *file, ngx_file_info_t *fi,
+    uint32_t *crc32)
+{
+    ngx_queue_t          *q;
+    ngx_http_js_cache_t  *cache;
+
+    if (ngx_http_js_cache.next == NULL) {
+        ngx_queue_init(&ngx_http_js_cache);
+        return NULL;
+    }
+
+    for (q = ngx_queue_head(&ngx_http_js_cache);
+         q != ngx_queue_sentinel(&ngx_http_js_cache);
+         q = ngx_queue_next(q))
+    {
+        cache = ngx_queue_data(q, ngx_http_js_cache_t, queue);
+
+        if (cache->size != (size_t) ngx_file_size(fi)
+            || cache->file.len != file->len
+            || ngx_strncmp(cache->file.data, file->data, file->len) != 0)
+        {
+            continue;
+        }
+
+        if (crc32 == NULL) {
+            if (cache->mtime == ngx_file_mtime(fi)
+                && cache->uniq == ngx_file_uniq(fi))
+            {
+                return cache;
+            }
+
+            continue;
+        }
+
+        if (cache->crc32 == *crc32) {
+
+            /* The file has been touched or replaced by a copy. */
+
+            cache->mtime = ngx_file_mtime(fi);
+            cache->uniq = ngx_file_uniq(fi);
+
+            return cache;
+        }
+    }
+
+    return NULL;
 }
 
 
@@ -970,7 +1056,7 @@ ngx_http_js_ext_get_string(njs_vm_t *vm, njs_value_t *value, void *obj,
 
     field = (ngx_str_t *) (p + data);
 
-    return njs_string_create(vm, value, field->data, field->len, 0);
+    return njs_vm_external_string_create(vm, value, field->data, field->len);
 }
 
 
@@ -1050,7 +1136,8 @@ ngx_http_js_ext_next_header(njs_vm_t *vm, njs_value_t *value, void *obj,
         header = entry->part->elts;
         h = &header[entry->item++];
 
-        return njs_string_create(vm, value, h->key.data, h->key.len, 0);
+        return njs_vm_external_string_create(vm, value,
+                                             h->key.data, h->key.len);
     }
 
     return NJS_DONE;
@@ -1106,10 +1193,11 @@ ngx_http_js_ext_get_header_out(njs_vm_t *vm, njs_value_t *value, void *obj,
     h = ngx_http_js_get_header(&r->headers_out.headers.part, v->start,
                                v->length);
     if (h == NULL) {
-        return njs_string_create(vm, value, NULL, 0, 0);
+        return njs_vm_external_string_create(vm, value, NULL, 0);
     }
 
-    return njs_string_create(vm, value, h->value.data, h->value.len, 0);
+    return njs_vm_external_string_create(vm, value,
+                                         h->value.data, h->value.len);
 }
 
 
@@ -1558,7 +1646,7 @@ ngx_http_js_ext_get_http_version(njs_vm_t *vm, njs_value_t *value, void *obj,
         break;
     }
 
-    return njs_string_create(vm, value, v.data, v.len, 0);
+    return njs_vm_external_string_create(vm, value, v.data, v.len);
 }
 
 
@@ -1572,7 +1660,8 @@ ngx_http_js_ext_get_remote_address(njs_vm_t *vm, njs_value_t *value, void *obj,
     r = (ngx_http_request_t *) obj;
     c = r->connection;
 
-    return njs_string_create(vm, value, c->addr_text.data, c->addr_text.len, 0);
+    return njs_vm_external_string_create(vm, value,
+                                         c->addr_text.data, c->addr_text.len);
 }
 
 
@@ -1643,7 +1732,7 @@ ngx_http_js_ext_get_request_body(njs_vm_t *vm, njs_value_t *value, void *obj,
 
 done:
 
-    ret = njs_string_create(vm, request_body, body, len, 0);
+    ret = njs_vm_external_string_create(vm, request_body, body, len);
 
     if (ret != NXT_OK) {
         return NJS_ERROR;
@@ -1690,10 +1779,11 @@ ngx_http_js_ext_get_header_in(njs_vm_t *vm, njs_value_t *value, void *obj,
     h = ngx_http_js_get_header(&r->headers_in.headers.part, v->start,
                                v->length);
     if (h == NULL) {
-        return njs_string_create(vm, value, NULL, 0, 0);
+        return njs_vm_external_string_create(vm, value, NULL, 0);
     }
 
-    return njs_string_create(vm, value, h->value.data, h->value.len, 0);
+    return njs_vm_external_string_create(vm, value,
+                                         h->value.data, h->value.len);
 }
 
 
@@ -1736,10 +1826,10 @@ ngx_http_js_ext_get_arg(njs_vm_t *vm, njs_value_t *value, void *obj,
     v = (nxt_str_t *) data;
 
     if (ngx_http_arg(r, v->start, v->length, &arg) == NGX_OK) {
-        return njs_string_create(vm, value, arg.data, arg.len, 0);
+        return njs_vm_external_string_create(vm, value, arg.data, arg.len);
     }
 
-    return njs_string_create(vm, value, NULL, 0, 0);
+    return njs_vm_external_string_create(vm, value, NULL, 0);
 }
 
 
@@ -1802,7 +1892,7 @@ ngx_http_js_ext_next_arg(njs_vm_t *vm, njs_value_t *value, void *obj,
         entry->len = 0;
     }
 
-    return njs_string_create(vm, value, start, len, 0);
+    return njs_vm_external_string_create(vm, value, start, len);
 }
 
 
@@ -1826,10 +1916,10 @@ ngx_http_js_ext_get_variable(njs_vm_t *vm, njs_value_t *value, void *obj,
 
     vv = ngx_http_get_variable(r, &name, key);
     if (vv == NULL || vv->not_found) {
-        return njs_string_create(vm, value, NULL, 0, 0);
+        return njs_vm_external_string_create(vm, value, NULL, 0);
     }
 
-    return njs_string_create(vm, value, vv->data, vv->len, 0);
+    return njs_vm_external_string_create(vm, value, vv->data, vv->len);
 }
 
 
@@ -2199,8 +2289,6 @@ static njs_ret_t
 ngx_http_js_ext_get_reply_body(njs_vm_t *vm, njs_value_t *value, void *obj,
 	uintptr_t data)
 {
-    size_t               len;
-    u_char              *p;
     ngx_buf_t           *b;
     ngx_http_request_t  *r;
 
@@ -2208,18 +2296,13 @@ ngx_http_js_ext_get_reply_body(njs_vm_t *vm, njs_value_t *value, void *obj,
 
     b = r->out ? r->out->buf : NULL;
 
-    len = b ? b->last - b->pos : 0;
-
-    p = njs_string_alloc(vm, value, len, 0);
-    if (p == NULL) {
-        return NJS_ERROR;
+    if (b == NULL) {
+        return njs_vm_external_string_create(vm, value, NULL, 0);
     }
 
-    if (len) {
-        ngx_memcpy(p, b->pos, len);
-    }
+    /* The subrequest output is kept in the main request pool. */
 
-    return NJS_OK;
+    return njs_vm_external_string_create(vm, value, b->pos, b->last - b->pos);
 }
 
 
@@ -2324,6 +2407,7 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     size_t                 size;
     u_char                *start, *end;
     ssize_t                n;
+    uint32_t               crc32;
     ngx_fd_t               fd;
     ngx_str_t             *value, file;
     nxt_int_t              rc;
@@ -2331,6 +2415,7 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     njs_vm_opt_t           options;
     ngx_file_info_t        fi;
     ngx_pool_cleanup_t    *cln;
+    ngx_http_js_cache_t   *cache;
 
     if (jmcf->vm) {
         return "is duplicate";
@@ -2357,6 +2442,19 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    cln = ngx_pool_cleanup_add(cf->pool, 0);
+    if (cln == NULL) {
+        (void) ngx_close_file(fd);
+        return NGX_CONF_ERROR;
+    }
+
+    cache = ngx_http_js_cache_lookup(&file, &fi, NULL);
+
+    if (cache != NULL) {
+        (void) ngx_close_file(fd);
+        goto cached;
+    }
+
     size = ngx_file_size(&fi);
 
     start = ngx_pnalloc(cf->pool, size);
@@ -2391,6 +2489,35 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 
     end = start + size;
 
+    crc32 = ngx_crc32_long(start, size);
+
+    cache = ngx_http_js_cache_lookup(&file, &fi, &crc32);
+
+    if (cache != NULL) {
+        goto cached;
+    }
+
+    cache = ngx_alloc(sizeof(ngx_http_js_cache_t) + file.len, cf->log);
+    if (cache == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    ngx_memzero(cache, sizeof(ngx_http_js_cache_t));
+
+    ngx_queue_init(&cache->queue);
+
+    cache->count = 1;
+    cache->file.len = file.len;
+    cache->file.data = (u_char *) cache + sizeof(ngx_http_js_cache_t);
+    ngx_memcpy(cache->file.data, file.data, file.len);
+    cache->size = size;
+    cache->mtime = ngx_file_mtime(&fi);
+    cache->uniq = ngx_file_uniq(&fi);
+    cache->crc32 = crc32;
+
+    cln->handler = ngx_http_js_cleanup_vm;
+    cln->data = cache;
+
     ngx_memzero(&options, sizeof(njs_vm_opt_t));
 
     options.backtrace = 1;
@@ -2402,13 +2529,7 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
-    cln = ngx_pool_cleanup_add(cf->pool, 0);
-    if (cln == NULL) {
-        return NGX_CONF_ERROR;
-    }
-
-    cln->handler = ngx_http_js_cleanup_vm;
-    cln->data = jmcf->vm;
+    cache->vm = jmcf->vm;
 
     jmcf->req_proto = njs_vm_external_prototype(jmcf->vm,
                                                 &ngx_http_js_externals[0]);
@@ -2425,6 +2546,9 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    cache->req_proto = jmcf->req_proto;
+    cache->res_proto = jmcf->res_proto;
+
     rc = njs_vm_compile(jmcf->vm, &start, end);
 
     if (rc != NJS_OK) {
@@ -2443,6 +2567,24 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    ngx_queue_insert_tail(&ngx_http_js_cache, &cache->queue);
+
+    return NGX_CONF_OK;
+
+cached:
+
+    cache->count++;
+
+    cln->handler = ngx_http_js_cleanup_vm;
+    cln->data = cache;
+
+    jmcf->vm = cache->vm;
+    jmcf->req_proto = cache->req_proto;
+    jmcf->res_proto = cache->res_proto;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, cf->log, 0,
+                   "js include \"%V\" is not changed", &file);
+
     return NGX_CONF_OK;
 }
 
@@ -52,6 +52,26 @@ typedef struct {
 } ngx_stream_js_event_t;
 
 
+/*
+ * A compiled VM is kept while any configuration cycle uses it, and it is
+ * reused on reload if the included file has the same name, size and
+ * checksum, so an unchanged script is not compiled again.  The file is
+ * not even read if its modification time and inode are not changed.
+ */
+
+typedef struct {
+    ngx_queue_t            queue;
+    ngx_uint_t             count;
+    ngx_str_t              file;
+    size_t                 size;
+    time_t                 mtime;
+    ngx_file_uniq_t        uniq;
+    uint32_t               crc32;
+    njs_vm_t              *vm;
+    const njs_extern_t    *proto;
+} ngx_stream_js_cache_t;
+
+
 static ngx_int_t ngx_stream_js_access_handler(ngx_stream_session_t *s);
 static ngx_int_t ngx_stream_js_preread_handler(ngx_stream_session_t *s);
 static ngx_int_t ngx_stream_js_phase_handler(ngx_stream_session_t *s,
@@ -63,6 +83,8 @@ static ngx_int_t ngx_stream_js_variable(ngx_stream_session_t *s,
 static ngx_int_t ngx_stream_js_init_vm(ngx_stream_session_t *s);
 static void ngx_stream_js_cleanup_ctx(void *data);
 static void ngx_stream_js_cleanup_vm(void *data);
+static ngx_stream_js_cache_t *ngx_stream_js_cache_lookup(ngx_str_t *file,
+    ngx_file_info_t *fi, uint32_t *crc32);
 static njs_ret_t ngx_stream_js_buffer_arg(ngx_stream_session_t *s,
     njs_value_t *buffer);
 static njs_ret_t ngx_stream_js_flags_arg(ngx_stream_session_t *s,
@@ -353,6 +375,9 @@ static njs_external_t  ngx_stream_js_externals[] = {
 };
 
 
+static ngx_queue_t  ngx_stream_js_cache;
+
+
 static njs_vm_ops_t ngx_stream_js_ops = {
     ngx_stream_js_set_timer,
     ngx_stream_js_clear_timer
@@ -770,9 +795,69 @@ ngx_stream_js_cleanup_ctx(void *data)
 static void
 ngx_stream_js_cleanup_vm(void *data)
 {
-    njs_vm_t *vm = data;
+    ngx_stream_js_cache_t *cache = data;
+
+    if (--cache->count != 0) {
+        return;
+    }
+
+    ngx_queue_remove(&cache->queue);
+
+    if (cache->vm != NULL) {
+        njs_vm_destroy(cache->vm);
+    }
+
+    ngx_free(cache);
+}
+
+
+static ngx_stream_js_cache_t *
+ngx_stream_js_cache_lookup(ngx_str_t *file, ngx_file_info_t *fi,
+    uint32_t *crc32)
+{
+    ngx_queue_t            *q;
+    ngx_stream_js_cache_t  *cache;
+
+    if (ngx_stream_js_cache.next == NULL) {
+        ngx_queue_init(&ngx_stream_js_cache);
+        return NULL;
+    }
+
+    for (q = ngx_queue_head(&ngx_stream_js_cache);
+         q != ngx_queue_sentinel(&ngx_stream_js_cache);
+         q = ngx_queue_next(q))
+    {
+        cache = ngx_queue_data(q, ngx_stream_js_cache_t, queue);
+
+        if (cache->size != (size_t) ngx_file_size(fi)
+            || cache->file.len != file->len
+            || ngx_strncmp(cache->file.data, file->data, file->len) != 0)
+        {
+            continue;
+        }
+
+        if (crc32 == NULL) {
+            if (cache->mtime == ngx_file_mtime(fi)
+                && cache->uniq == ngx_file_uniq(fi))
+            {
+                return cache;
+            }
+
+            continue;
+        }
+
+        if (cache->crc32 == *crc32) {
+
+            /* The file has been touched or replaced by a copy. */
 
-    njs_vm_destroy(vm);
+            cache->mtime = ngx_file_mtime(fi);
+            cache->uniq = ngx_file_uniq(fi);
+
+            return cache;
+        }
+    }
+
+    return NULL;
 }
 
 
@@ -792,6 +877,8 @@ ngx_stream_js_buffer_arg(ngx_stream_session_t *s, njs_value_t *buffer)
 
     len = b ? b->last - b->pos : 0;
 
+    /* The buffer is reused for the next data, so it is copied. */
+
     p = njs_string_alloc(ctx->vm, buffer, len, 0);
     if (p == NULL) {
         return NJS_ERROR;
@@ -819,8 +906,8 @@ ngx_stream_js_flags_arg(ngx_stream_session_t *s, njs_value_t *flags)
 
     ctx = ngx_stream_get_module_ctx(s, ngx_stream_js_module);
 
-    njs_string_create(ctx->vm, njs_value_arg(&last_key), last_str.start,
-                      last_str.length, 0);
+    njs_vm_external_string_create(ctx->vm, njs_value_arg(&last_key),
+                                  last_str.start, last_str.length);
 
     c = s->connection;
 
@@ -883,7 +970,8 @@ ngx_stream_js_ext_get_remote_address(njs_vm_t *vm, njs_value_t *value,
     s = (ngx_stream_session_t *) obj;
     c = s->connection;
 
-    return njs_string_create(vm, value, c->addr_text.data, c->addr_text.len, 0);
+    return njs_vm_external_string_create(vm, value,
+                                         c->addr_text.data, c->addr_text.len);
 }
 
 
@@ -1200,10 +1288,10 @@ ngx_stream_js_ext_get_variable(njs_vm_t *vm, njs_value_t *value, void *obj,
 
     vv = ngx_stream_get_variable(s, &name, key);
     if (vv == NULL || vv->not_found) {
-        return njs_string_create(vm, value, NULL, 0, 0);
+        return njs_vm_external_string_create(vm, value, NULL, 0);
     }
 
-    return njs_string_create(vm, value, vv->data, vv->len, 0);
+    return njs_vm_external_string_create(vm, value, vv->data, vv->len);
 }
 
 
@@ -1300,16 +1388,18 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 {
     ngx_stream_js_main_conf_t *jmcf = conf;
 
-    size_t                 size;
-    u_char                *start, *end;
-    ssize_t                n;
-    ngx_fd_t               fd;
-    ngx_str_t             *value, file;
-    nxt_int_t              rc;
-    nxt_str_t              text;
-    njs_vm_opt_t           options;
-    ngx_file_info_t        fi;
-    ngx_pool_cleanup_t    *cln;
+    size_t                  size;
+    u_char                 *start, *end;
+    ssize_t                 n;
+    uint32_t                crc32;
+    ngx_fd_t                fd;
+    ngx_str_t              *value, file;
+    nxt_int_t               rc;
+    nxt_str_t               text;
+    njs_vm_opt_t            options;
+    ngx_file_info_t         fi;
+    ngx_pool_cleanup_t     *cln;
+    ngx_stream_js_cache_t  *cache;
 
     if (jmcf->vm) {
         return "is duplicate";
@@ -1336,6 +1426,19 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    cln = ngx_pool_cleanup_add(cf->pool, 0);
+    if (cln == NULL) {
+        (void) ngx_close_file(fd);
+        return NGX_CONF_ERROR;
+    }
+
+    cache = ngx_stream_js_cache_lookup(&file, &fi, NULL);
+
+    if (cache != NULL) {
+        (void) ngx_close_file(fd);
+        goto cached;
+    }
+
     size = ngx_file_size(&fi);
 
     start = ngx_pnalloc(cf->pool, size);
@@ -1370,6 +1473,35 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 
     end = start + size;
 
+    crc32 = ngx_crc32_long(start, size);
+
+    cache = ngx_stream_js_cache_lookup(&file, &fi, &crc32);
+
+    if (cache != NULL) {
+        goto cached;
+    }
+
+    cache = ngx_alloc(sizeof(ngx_stream_js_cache_t) + file.len, cf->log);
+    if (cache == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    ngx_memzero(cache, sizeof(ngx_stream_js_cache_t));
+
+    ngx_queue_init(&cache->queue);
+
+    cache->count = 1;
+    cache->file.len = file.len;
+    cache->file.data = (u_char *) cache + sizeof(ngx_stream_js_cache_t);
+    ngx_memcpy(cache->file.data, file.data, file.len);
+    cache->size = size;
+    cache->mtime = ngx_file_mtime(&fi);
+    cache->uniq = ngx_file_uniq(&fi);
+    cache->crc32 = crc32;
+
+    cln->handler = ngx_stream_js_cleanup_vm;
+    cln->data = cache;
+
     ngx_memzero(&options, sizeof(njs_vm_opt_t));
 
     options.backtrace = 1;
@@ -1381,13 +1513,7 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
-    cln = ngx_pool_cleanup_add(cf->pool, 0);
-    if (cln == NULL) {
-        return NGX_CONF_ERROR;
-    }
-
-    cln->handler = ngx_stream_js_cleanup_vm;
-    cln->data = jmcf->vm;
+    cache->vm = jmcf->vm;
 
     jmcf->proto = njs_vm_external_prototype(jmcf->vm,
                                             &ngx_stream_js_externals[0]);
@@ -1397,6 +1523,8 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    cache->proto = jmcf->proto;
+
     rc = njs_vm_compile(jmcf->vm, &start, end);
 
     if (rc != NJS_OK) {
@@ -1415,6 +1543,23 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    ngx_queue_insert_tail(&ngx_stream_js_cache, &cache->queue);
+
+    return NGX_CONF_OK;
+
+cached:
+
+    cache->count++;
+
+    cln->handler = ngx_stream_js_cleanup_vm;
+    cln->data = cache;
+
+    jmcf->vm = cache->vm;
+    jmcf->proto = cache->proto;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_STREAM, cf->log, 0,
+                   "js include \"%V\" is not changed", &file);
+
     return NGX_CONF_OK;
 }
 
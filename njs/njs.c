@@ -9,6 +9,9 @@
 #include <string.h>
 
 
+static nxt_mem_cache_pool_t *njs_vm_mem_cache_pool_create(
+    const nxt_mem_proto_t *proto, void *mem, nxt_bool_t arena);
+static void njs_vm_compile_release(njs_vm_t *vm);
 static nxt_int_t njs_vm_init(njs_vm_t *vm);
 static nxt_int_t njs_vm_handle_events(njs_vm_t *vm);
 
@@ -92,10 +95,8 @@ njs_vm_create(njs_vm_opt_t *options)
     nxt_int_t             ret;
     nxt_array_t           *debug;
     nxt_mem_cache_pool_t  *mcp;
-    njs_regexp_pattern_t  *pattern;
 
-    mcp = nxt_mem_cache_pool_create(&njs_vm_mem_cache_pool_proto, NULL,
-                                    NULL, 2 * nxt_pagesize(), 128, 512, 16);
+    mcp = njs_vm_mem_cache_pool_create(options->mem_proto, options->mem, 0);
     if (nxt_slow_path(mcp == NULL)) {
         return NULL;
     }
@@ -112,34 +113,22 @@ njs_vm_create(njs_vm_opt_t *options)
 
         vm->options = *options;
 
+        vm->trace.level = NXT_LEVEL_TRACE;
+        vm->trace.size = 2048;
+        vm->trace.handler = njs_parser_trace_handler;
+        vm->trace.data = vm;
+
         if (options->shared != NULL) {
             vm->shared = options->shared;
 
         } else {
-            vm->shared = nxt_mem_cache_zalloc(mcp, sizeof(njs_vm_shared_t));
+            vm->shared = nxt_mem_cache_alloc(mcp, sizeof(njs_vm_shared_t));
             if (nxt_slow_path(vm->shared == NULL)) {
                 return NULL;
             }
 
             options->shared = vm->shared;
 
-            nxt_lvlhsh_init(&vm->shared->keywords_hash);
-
-            ret = njs_lexer_keywords_init(mcp, &vm->shared->keywords_hash);
-            if (nxt_slow_path(ret != NXT_OK)) {
-                return NULL;
-            }
-
-            nxt_lvlhsh_init(&vm->shared->values_hash);
-
-            pattern = njs_regexp_pattern_create(vm, (u_char *) "(?:)",
-                                                nxt_length("(?:)"), 0);
-            if (nxt_slow_path(pattern == NULL)) {
-                return NULL;
-            }
-
-            vm->shared->empty_regexp_pattern = pattern;
-
             nxt_lvlhsh_init(&vm->modules_hash);
 
             ret = njs_builtin_objects_create(vm);
@@ -149,6 +138,7 @@ njs_vm_create(njs_vm_opt_t *options)
         }
 
         nxt_lvlhsh_init(&vm->values_hash);
+        nxt_lvlhsh_init(&vm->atoms);
 
         vm->external = options->external;
 
@@ -162,11 +152,6 @@ njs_vm_create(njs_vm_opt_t *options)
         nxt_lvlhsh_init(&vm->externals_hash);
         nxt_lvlhsh_init(&vm->external_prototypes_hash);
 
-        vm->trace.level = NXT_LEVEL_TRACE;
-        vm->trace.size = 2048;
-        vm->trace.handler = njs_parser_trace_handler;
-        vm->trace.data = vm;
-
         if (options->backtrace) {
             debug = nxt_array_create(4, sizeof(njs_function_debug_t),
                                      &njs_array_mem_proto,
@@ -216,36 +201,57 @@ njs_vm_destroy(njs_vm_t *vm)
 }
 
 
+void
+njs_vm_thread_cache_flush(void)
+{
+    nxt_mem_cache_pool_thread_cache_flush();
+}
+
+
 nxt_int_t
 njs_vm_compile(njs_vm_t *vm, u_char **start, u_char *end)
 {
     nxt_int_t          ret;
     njs_lexer_t        *lexer;
-    njs_parser_t       *parser, *prev;
+    njs_parser_t       *parser;
     njs_parser_node_t  *node;
 
-    parser = nxt_mem_cache_zalloc(vm->mem_cache_pool, sizeof(njs_parser_t));
-    if (nxt_slow_path(parser == NULL)) {
+    if (vm->cloned) {
+        return NJS_ERROR;
+    }
+
+    if (vm->global_scope != NULL && !vm->options.accumulative) {
         return NJS_ERROR;
     }
 
-    if (vm->parser != NULL && !vm->options.accumulative) {
+    /*
+     * Compiler data are released after compilation, global variables
+     * of the accumulative mode are kept in the VM pool.  A temporary
+     * pool does not need to release memory.
+     */
+
+    vm->compile_pool = njs_vm_mem_cache_pool_create(vm->options.mem_proto,
+                                                    vm->options.mem, 1);
+    if (nxt_slow_path(vm->compile_pool == NULL)) {
         return NJS_ERROR;
     }
 
-    prev = vm->parser;
+    parser = nxt_mem_cache_zalloc(vm->compile_pool, sizeof(njs_parser_t));
+    if (nxt_slow_path(parser == NULL)) {
+        goto fail;
+    }
+
     vm->parser = parser;
 
-    lexer = nxt_mem_cache_zalloc(vm->mem_cache_pool, sizeof(njs_lexer_t));
+    lexer = nxt_mem_cache_zalloc(vm->compile_pool, sizeof(njs_lexer_t));
     if (nxt_slow_path(lexer == NULL)) {
-        return NJS_ERROR;
+        goto fail;
     }
 
     parser->lexer = lexer;
     lexer->start = *start;
     lexer->end = end;
     lexer->line = 1;
-    lexer->keywords_hash = vm->shared->keywords_hash;
 
     parser->code_size = sizeof(njs_vmcode_stop_t);
     parser->scope_offset = NJS_INDEX_GLOBAL_OFFSET;
@@ -254,7 +260,7 @@ njs_vm_compile(njs_vm_t *vm, u_char **start, u_char *end)
         nxt_array_reset(vm->backtrace);
     }
 
-    node = njs_parser(vm, parser, prev);
+    node = njs_parser(vm, parser);
     if (nxt_slow_path(node == NULL)) {
         goto fail;
     }
@@ -277,24 +283,56 @@ njs_vm_compile(njs_vm_t *vm, u_char **start, u_char *end)
         goto fail;
     }
 
+    if (vm->options.accumulative) {
+        ret = njs_variables_global_merge(vm, parser->scope);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            goto fail;
+        }
+
+    } else {
+        vm->variables_hash = parser->scope->variables;
+    }
+
     vm->current = parser->code_start;
 
     vm->global_scope = parser->local_scope;
     vm->scope_size = parser->scope_size;
-    vm->variables_hash = parser->scope->variables;
+
+    njs_vm_compile_release(vm);
 
     return NJS_OK;
 
 fail:
 
-    vm->parser = prev;
+    njs_vm_compile_release(vm);
 
     return NXT_ERROR;
 }
 
 
+static void
+njs_vm_compile_release(njs_vm_t *vm)
+{
+    /* Code, constants, and variables are allocated in the VM pool. */
+
+    nxt_mem_cache_pool_destroy(vm->compile_pool);
+
+    vm->compile_pool = NULL;
+    vm->parser = NULL;
+}
+
+
 njs_vm_t *
 njs_vm_clone(njs_vm_t *vm, njs_external_ptr_t external)
+{
+    return njs_vm_clone_mem(vm, external, vm->options.mem_proto,
+                            vm->options.mem);
+}
+
+
+njs_vm_t *
+njs_vm_clone_mem(njs_vm_t *vm, njs_external_ptr_t external,
+    const nxt_mem_proto_t *proto, void *mem)
 {
     njs_vm_t              *nvm;
     uint32_t              items;
@@ -308,8 +346,7 @@ njs_vm_clone(njs_vm_t *vm, njs_external_ptr_t external)
         return NULL;
     }
 
-    nmcp = nxt_mem_cache_pool_create(&njs_vm_mem_cache_pool_proto, NULL,
-                                    NULL, 2 * nxt_pagesize(), 128, 512, 16);
+    nmcp = njs_vm_mem_cache_pool_create(proto, mem, vm->options.arena);
     if (nxt_slow_path(nmcp == NULL)) {
         return NULL;
     }
@@ -355,6 +392,8 @@ njs_vm_clone(njs_vm_t *vm, njs_external_ptr_t external)
 
         nvm->debug = vm->debug;
 
+        nvm->cloned = 1;
+
         ret = njs_vm_init(nvm);
         if (nxt_slow_path(ret != NXT_OK)) {
             goto fail;
@@ -373,6 +412,25 @@ fail:
 }
 
 
+static nxt_mem_cache_pool_t *
+njs_vm_mem_cache_pool_create(const nxt_mem_proto_t *proto, void *mem,
+    nxt_bool_t arena)
+{
+    if (proto == NULL) {
+        proto = &njs_vm_mem_cache_pool_proto;
+        mem = NULL;
+    }
+
+    if (arena) {
+        return nxt_mem_cache_pool_arena_create(proto, mem, NULL,
+                                               NJS_ARENA_REGION_SIZE);
+    }
+
+    return nxt_mem_cache_pool_create(proto, mem, NULL, 2 * nxt_pagesize(),
+                                     128, 512, 16);
+}
+
+
 static nxt_int_t
 njs_vm_init(njs_vm_t *vm)
 {
@@ -671,6 +729,14 @@ njs_vm_memory_error(njs_vm_t *vm)
 }
 
 
+njs_ret_t
+njs_vm_external_string_create(njs_vm_t *vm, njs_value_t *value,
+    const u_char *start, uint32_t size)
+{
+    return njs_string_create(vm, value, (u_char *) start, size, 0);
+}
+
+
 njs_ret_t njs_vm_retval_to_ext_string(njs_vm_t *vm, nxt_str_t *retval)
 {
     if (vm->top_frame == NULL) {
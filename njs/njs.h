@@ -146,9 +146,66 @@ typedef struct {
     uint8_t                         accumulative;    /* 1 bit */
     uint8_t                         backtrace;       /* 1 bit */
     uint8_t                         sandbox;         /* 1 bit */
+
+    /*
+     * Cloned VMs allocate memory from large regions which are released
+     * only when the VM is destroyed.  This makes allocations cheaper
+     * for short-lived VMs at the cost of memory freed during their run.
+     */
+    uint8_t                         arena;           /* 1 bit */
+
+    /*
+     * An allocator of VM memory, the system allocator is used if it is NULL.
+     * The alloc(), zalloc(), align(), and free() callbacks are required,
+     * mem is passed to them as the first argument.  Cloned VMs use the same
+     * allocator unless another one is provided to njs_vm_clone_mem().
+     * Memory pages are allocated and freed often during the VM lifetime,
+     * so free() must return memory for reuse.  align() must support any
+     * power of 2 alignment up to the pool cluster size, twice the system
+     * page size: free() finds the cluster of a freed chunk in the page map
+     * by masking its address, so a cluster that is not aligned to its
+     * size corrupts the pool.  An allocator provided to njs_vm_clone_mem()
+     * has the same requirements.
+     */
+    const nxt_mem_proto_t           *mem_proto;
+    void                            *mem;
 } njs_vm_opt_t;
 
 
+/*
+ * njs_vm_compile() can be called once for a VM unless the VM is created
+ * with the "accumulative" option.  A VM whose compilation failed can be
+ * used to compile another script.
+ */
+
+/*
+ * NJS and threads.
+ *
+ * A VM is not thread-safe itself: njs_vm_create(), njs_vm_compile(),
+ * njs_vm_external_prototype() and njs_vm_external_bind() must be called
+ * for a parent VM in one thread before any clone of it is created.
+ *
+ * After that the parent VM is read-only, so a compiled non-accumulative
+ * parent VM can be cloned concurrently by njs_vm_clone() in any number of
+ * threads as long as the parent VM is not destroyed.  Each cloned VM has
+ * its own memory pool and must be used and destroyed by one thread at a
+ * time.  njs_vm_compile() fails for cloned VMs since they share compiled
+ * code and constants with the parent VM.
+ *
+ * Different parent VMs can be created by njs_vm_create() concurrently:
+ * the builtin objects shared by all VMs are created once by the first
+ * call using pthread_once().  If njs is built without POSIX threads, the
+ * first njs_vm_create() must complete before any other one starts.
+ *
+ * Memory of destroyed VMs is cached by the thread for reuse by its next
+ * VMs.  A thread that has used VMs should call njs_vm_thread_cache_flush()
+ * before it exits, otherwise the cached memory is leaked.
+ *
+ * All of the above requires thread local storage.  If the compiler does
+ * not support it, NXT_THREADS is 0, configure reports that thread-safe
+ * mode is disabled, and VMs must not be used in different threads.
+ */
+
 #define NJS_OK                      NXT_OK
 #define NJS_ERROR                   NXT_ERROR
 #define NJS_AGAIN                   NXT_AGAIN
@@ -158,9 +215,12 @@ typedef struct {
 
 NXT_EXPORT njs_vm_t *njs_vm_create(njs_vm_opt_t *options);
 NXT_EXPORT void njs_vm_destroy(njs_vm_t *vm);
+NXT_EXPORT void njs_vm_thread_cache_flush(void);
 
 NXT_EXPORT nxt_int_t njs_vm_compile(njs_vm_t *vm, u_char **start, u_char *end);
 NXT_EXPORT njs_vm_t *njs_vm_clone(njs_vm_t *vm, njs_external_ptr_t external);
+NXT_EXPORT njs_vm_t *njs_vm_clone_mem(njs_vm_t *vm,
+    njs_external_ptr_t external, const nxt_mem_proto_t *proto, void *mem);
 NXT_EXPORT nxt_int_t njs_vm_call(njs_vm_t *vm, njs_function_t *function,
     const njs_value_t *args, nxt_uint_t nargs);
 
@@ -195,6 +255,18 @@ NXT_EXPORT u_char * njs_string_alloc(njs_vm_t *vm, njs_value_t *value,
 NXT_EXPORT njs_ret_t njs_string_create(njs_vm_t *vm, njs_value_t *value,
     u_char *start, uint32_t size, uint32_t length);
 
+/*
+ * njs_vm_external_string_create() creates a byte string which refers to
+ * host memory instead of copying it, only strings up to 14 bytes are
+ * copied into the value.  The memory must not be changed or freed while
+ * the VM is used, up to njs_vm_destroy(): the string and its slices may
+ * be stored in any object of the VM.  Data which is reused or freed
+ * earlier, such as a connection buffer, should be copied to a string
+ * allocated by njs_string_alloc().
+ */
+NXT_EXPORT njs_ret_t njs_vm_external_string_create(njs_vm_t *vm,
+    njs_value_t *value, const u_char *start, uint32_t size);
+
 NXT_EXPORT nxt_int_t njs_value_string_copy(njs_vm_t *vm, nxt_str_t *retval,
     const njs_value_t *value, uintptr_t *next);
 
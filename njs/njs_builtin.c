@@ -15,6 +15,9 @@
 #include <njs_crypto.h>
 #include <string.h>
 #include <stdio.h>
+#if (NXT_HAVE_PTHREAD)
+#include <pthread.h>
+#endif
 
 
 typedef struct {
@@ -23,6 +26,8 @@ typedef struct {
 } njs_function_init_t;
 
 
+static void njs_builtin_shared_create(void);
+static nxt_int_t njs_builtin_shared_objects_create(njs_vm_t *vm);
 static nxt_int_t njs_builtin_completions(njs_vm_t *vm, size_t *size,
     nxt_str_t *completions);
 static nxt_array_t *njs_vm_expression_completions(njs_vm_t *vm,
@@ -127,6 +132,23 @@ const njs_function_init_t  njs_native_functions[] = {
 };
 
 
+/*
+ * The builtin objects and their property hashes are created once by the
+ * first njs_vm_create() and are copied by the subsequent ones.  The tables
+ * are never changed and are never freed, they are allocated by the default
+ * allocator in a process-wide pool, so nginx worker processes share their
+ * pages after fork().  pthread_once() allows the first VMs to be created
+ * concurrently.  If the tables cannot be created, njs_vm_create() fails.
+ */
+
+static njs_vm_shared_t  *njs_builtin_shared;
+static njs_module_t     njs_builtin_modules[NJS_MODULE_MAX];
+
+#if (NXT_HAVE_PTHREAD)
+static pthread_once_t   njs_builtin_once = PTHREAD_ONCE_INIT;
+#endif
+
+
 static njs_ret_t
 njs_prototype_function(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
@@ -139,13 +161,151 @@ njs_prototype_function(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
 nxt_int_t
 njs_builtin_objects_create(njs_vm_t *vm)
+{
+    nxt_int_t           ret;
+    nxt_uint_t          i;
+    njs_module_t        *module;
+    nxt_lvlhsh_query_t  lhq;
+
+#if (NXT_HAVE_PTHREAD)
+    (void) pthread_once(&njs_builtin_once, njs_builtin_shared_create);
+
+#else
+    if (njs_builtin_shared == NULL) {
+        njs_builtin_shared_create();
+    }
+#endif
+
+    if (nxt_slow_path(njs_builtin_shared == NULL)) {
+        njs_memory_error(vm);
+        return NXT_ERROR;
+    }
+
+    *vm->shared = *njs_builtin_shared;
+
+    lhq.replace = 0;
+    lhq.proto = &njs_modules_hash_proto;
+    lhq.pool = vm->mem_cache_pool;
+
+    for (i = NJS_MODULE_FS; i < NJS_MODULE_MAX; i++) {
+        if (vm->options.sandbox && !njs_sandbox_module(i)) {
+            continue;
+        }
+
+        module = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_module_t));
+        if (nxt_slow_path(module == NULL)) {
+            njs_memory_error(vm);
+            return NXT_ERROR;
+        }
+
+        *module = njs_builtin_modules[i];
+
+        lhq.key = module->name;
+        lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
+        lhq.value = module;
+
+        ret = nxt_lvlhsh_insert(&vm->modules_hash, &lhq);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NXT_ERROR;
+        }
+    }
+
+    return NXT_OK;
+}
+
+
+static void
+njs_builtin_shared_create(void)
+{
+    njs_vm_t              *bvm;
+    nxt_int_t             ret;
+    nxt_uint_t            i;
+    nxt_mem_cache_pool_t  *mcp;
+    njs_regexp_pattern_t  *pattern;
+
+    mcp = nxt_mem_cache_pool_create(&njs_vm_mem_cache_pool_proto, NULL, NULL,
+                                    2 * nxt_pagesize(), 128, 512, 16);
+    if (nxt_slow_path(mcp == NULL)) {
+        return;
+    }
+
+    /*
+     * The objects are created by a temporary VM which provides
+     * the process-wide pool and regex context.
+     */
+
+    bvm = nxt_mem_cache_zalign(mcp, sizeof(njs_value_t), sizeof(njs_vm_t));
+    if (nxt_slow_path(bvm == NULL)) {
+        goto fail;
+    }
+
+    bvm->mem_cache_pool = mcp;
+
+    bvm->trace.level = NXT_LEVEL_TRACE;
+    bvm->trace.size = 2048;
+    bvm->trace.handler = njs_parser_trace_handler;
+    bvm->trace.data = bvm;
+
+    bvm->shared = nxt_mem_cache_zalloc(mcp, sizeof(njs_vm_shared_t));
+    if (nxt_slow_path(bvm->shared == NULL)) {
+        goto fail;
+    }
+
+    ret = njs_regexp_init(bvm);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        goto fail;
+    }
+
+    nxt_lvlhsh_init(&bvm->shared->values_hash);
+
+    pattern = njs_regexp_pattern_create(bvm, (u_char *) "(?:)",
+                                        nxt_length("(?:)"), 0);
+    if (nxt_slow_path(pattern == NULL)) {
+        goto fail;
+    }
+
+    bvm->shared->empty_regexp_pattern = pattern;
+
+    ret = njs_builtin_shared_objects_create(bvm);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        goto fail;
+    }
+
+    for (i = NJS_MODULE_FS; i < NJS_MODULE_MAX; i++) {
+        njs_builtin_modules[i].name = njs_module_init[i]->name;
+
+        ret = njs_object_hash_create(bvm,
+                                     &njs_builtin_modules[i].object.shared_hash,
+                                     njs_module_init[i]->properties,
+                                     njs_module_init[i]->items);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            goto fail;
+        }
+
+        njs_builtin_modules[i].object.shared = 1;
+    }
+
+    njs_builtin_shared = bvm->shared;
+
+    nxt_mem_cache_free(mcp, bvm);
+
+    return;
+
+fail:
+
+    nxt_mem_cache_pool_destroy(mcp);
+
+    nxt_memzero(njs_builtin_modules, sizeof(njs_builtin_modules));
+}
+
+
+static nxt_int_t
+njs_builtin_shared_objects_create(njs_vm_t *vm)
 {
     nxt_int_t               ret;
     nxt_uint_t              i;
-    njs_module_t            *module;
     njs_object_t            *objects;
     njs_function_t          *functions, *constructors;
-    nxt_lvlhsh_query_t      lhq;
     njs_object_prototype_t  *prototypes;
 
     static const njs_object_prototype_t  prototype_values[] = {
@@ -251,41 +411,6 @@ njs_builtin_objects_create(njs_vm_t *vm)
         objects[i].shared = 1;
     }
 
-    lhq.replace = 0;
-    lhq.proto = &njs_modules_hash_proto;
-    lhq.pool = vm->mem_cache_pool;
-
-    for (i = NJS_MODULE_FS; i < NJS_MODULE_MAX; i++) {
-        if (vm->options.sandbox && !njs_sandbox_module(i)) {
-            continue;
-        }
-
-        module = nxt_mem_cache_zalloc(vm->mem_cache_pool, sizeof(njs_module_t));
-        if (nxt_slow_path(module == NULL)) {
-            return NJS_ERROR;
-        }
-
-        module->name = njs_module_init[i]->name;
-
-        ret = njs_object_hash_create(vm, &module->object.shared_hash,
-                                     njs_module_init[i]->properties,
-                                     njs_module_init[i]->items);
-        if (nxt_slow_path(ret != NXT_OK)) {
-            return NXT_ERROR;
-        }
-
-        module->object.shared = 1;
-
-        lhq.key = module->name;
-        lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
-        lhq.value = module;
-
-        ret = nxt_lvlhsh_insert(&vm->modules_hash, &lhq);
-        if (nxt_fast_path(ret != NXT_OK)) {
-            return NXT_ERROR;
-        }
-    }
-
     functions = vm->shared->functions;
 
     for (i = NJS_FUNCTION_EVAL; i < NJS_FUNCTION_MAX; i++) {
@@ -510,31 +635,25 @@ njs_builtin_completions(njs_vm_t *vm, size_t *size, nxt_str_t *completions)
     nxt_str_t               string;
     nxt_uint_t              i, k;
     njs_object_t            *objects;
-    njs_keyword_t           *keyword;
     njs_function_t          *constructors;
     njs_object_prop_t       *prop;
     nxt_lvlhsh_each_t       lhe, lhe_prop;
     njs_extern_value_t      *ev;
     const njs_extern_t      *ext_proto, *ext_prop;
+    const njs_keyword_t     *keyword;
     njs_object_prototype_t  *prototypes;
 
     n = 0;
 
-    nxt_lvlhsh_each_init(&lhe, &njs_keyword_hash_proto);
+    keyword = njs_lexer_keywords(&k);
 
-    for ( ;; ) {
-        keyword = nxt_lvlhsh_each(&vm->shared->keywords_hash, &lhe);
-
-        if (keyword == NULL) {
-            break;
+    if (completions != NULL) {
+        for (i = 0; i < k; i++) {
+            completions[n++] = keyword[i].name;
         }
 
-        if (completions != NULL) {
-            completions[n++] = keyword->name;
-
-        } else {
-            n++;
-        }
+    } else {
+        n += k;
     }
 
     objects = vm->shared->objects;
@@ -723,7 +842,7 @@ njs_vm_expression_completions(njs_vm_t *vm, nxt_str_t *expression)
     njs_object_prop_t   *prop;
     nxt_lvlhsh_query_t  lhq;
 
-    if (nxt_slow_path(vm->parser == NULL)) {
+    if (nxt_slow_path(vm->scopes[NJS_SCOPE_GLOBAL] == NULL)) {
         return NULL;
     }
 
@@ -738,7 +857,7 @@ njs_vm_expression_completions(njs_vm_t *vm, nxt_str_t *expression)
     lhq.key.length = p - lhq.key.start;
     lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
 
-    ret = nxt_lvlhsh_find(&vm->parser->scope->variables, &lhq);
+    ret = nxt_lvlhsh_find(&vm->variables_hash, &lhq);
     if (nxt_slow_path(ret != NXT_OK)) {
         return NULL;
     }
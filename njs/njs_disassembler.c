@@ -22,6 +22,10 @@ static njs_code_name_t  code_names[] = {
 
     { njs_vmcode_object, sizeof(njs_vmcode_object_t),
           nxt_string("OBJECT          ") },
+    { njs_vmcode_object_template, sizeof(njs_vmcode_object_template_t),
+          nxt_string("OBJECT TEMPLATE ") },
+    { njs_vmcode_array_template, sizeof(njs_vmcode_array_template_t),
+          nxt_string("ARRAY TEMPLATE  ") },
     { njs_vmcode_function, sizeof(njs_vmcode_function_t),
           nxt_string("FUNCTION        ") },
     { njs_vmcode_regexp, sizeof(njs_vmcode_regexp_t),
@@ -58,6 +58,12 @@ static nxt_int_t njs_generate_object(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node);
 static nxt_int_t njs_generate_array(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node);
+static nxt_int_t njs_generate_object_template(njs_vm_t *vm,
+    njs_parser_t *parser, njs_parser_node_t *node);
+static nxt_int_t njs_generate_array_template(njs_vm_t *vm,
+    njs_parser_t *parser, njs_parser_node_t *node);
+static nxt_int_t njs_generate_template_value(njs_vm_t *vm,
+    njs_parser_t *parser, njs_value_t *value);
 static nxt_int_t njs_generate_function(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node);
 static nxt_int_t njs_generate_regexp(njs_vm_t *vm, njs_parser_t *parser,
@@ -703,7 +709,7 @@ njs_generate_switch_statement(njs_vm_t *vm, njs_parser_t *parser,
                 return ret;
             }
 
-            patch = nxt_mem_cache_alloc(vm->mem_cache_pool,
+            patch = nxt_mem_cache_alloc(vm->compile_pool,
                                         sizeof(njs_parser_patch_t));
             if (nxt_slow_path(patch == NULL)) {
                 return NXT_ERROR;
@@ -741,7 +747,7 @@ njs_generate_switch_statement(njs_vm_t *vm, njs_parser_t *parser,
             *patch->address += parser->code_end - (u_char *) patch->address;
             next = patch->next;
 
-            nxt_mem_cache_free(vm->mem_cache_pool, patch);
+            nxt_mem_cache_free(vm->compile_pool, patch);
 
             patch = next;
             node = branch->right;
@@ -1068,7 +1074,7 @@ njs_generate_start_block(njs_vm_t *vm, njs_parser_t *parser,
 {
     njs_parser_block_t  *block;
 
-    block = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_parser_block_t));
+    block = nxt_mem_cache_alloc(vm->compile_pool, sizeof(njs_parser_block_t));
 
     if (nxt_fast_path(block != NULL)) {
         block->next = parser->block;
@@ -1098,7 +1104,7 @@ njs_generate_patch_loop_continuation(njs_vm_t *vm, njs_parser_t *parser)
         *patch->address += parser->code_end - (u_char *) patch->address;
         next = patch->next;
 
-        nxt_mem_cache_free(vm->mem_cache_pool, patch);
+        nxt_mem_cache_free(vm->compile_pool, patch);
     }
 }
 
@@ -1116,10 +1122,10 @@ njs_generate_patch_block_exit(njs_vm_t *vm, njs_parser_t *parser)
         *patch->address += parser->code_end - (u_char *) patch->address;
         next = patch->next;
 
-        nxt_mem_cache_free(vm->mem_cache_pool, patch);
+        nxt_mem_cache_free(vm->compile_pool, patch);
     }
 
-    nxt_mem_cache_free(vm->mem_cache_pool, block);
+    nxt_mem_cache_free(vm->compile_pool, block);
 }
 
 
@@ -1145,7 +1151,7 @@ found:
 
     /* TODO: LABEL */
 
-    patch = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_parser_patch_t));
+    patch = nxt_mem_cache_alloc(vm->compile_pool, sizeof(njs_parser_patch_t));
 
     if (nxt_fast_path(patch != NULL)) {
         patch->next = block->continuation;
@@ -1188,7 +1194,7 @@ found:
 
     /* TODO: LABEL: loop and switch may have label, block must have label. */
 
-    patch = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_parser_patch_t));
+    patch = nxt_mem_cache_alloc(vm->compile_pool, sizeof(njs_parser_patch_t));
 
     if (nxt_fast_path(patch != NULL)) {
         patch->next = block->exit;
@@ -1548,11 +1554,24 @@ njs_generate_operation_assignment(njs_vm_t *vm, njs_parser_t *parser,
 }
 
 
+#define njs_generator_constant(node)                                          \
+    ((node)->token >= NJS_TOKEN_FIRST_CONST                                   \
+     && (node)->token <= NJS_TOKEN_LAST_CONST)
+
+
 static nxt_int_t
 njs_generate_object(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *node)
 {
+    nxt_int_t            ret;
     njs_vmcode_object_t  *object;
 
+    if (node->left != NULL) {
+        ret = njs_generate_object_template(vm, parser, node);
+        if (ret != NXT_DECLINED) {
+            return ret;
+        }
+    }
+
     node->index = njs_generator_object_dest_index(vm, parser, node);
     if (nxt_slow_path(node->index == NJS_INDEX_ERROR)) {
         return NXT_ERROR;
@@ -1572,8 +1591,16 @@ njs_generate_object(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *node)
 static nxt_int_t
 njs_generate_array(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *node)
 {
+    nxt_int_t           ret;
     njs_vmcode_array_t  *array;
 
+    if (node->left != NULL) {
+        ret = njs_generate_array_template(vm, parser, node);
+        if (ret != NXT_DECLINED) {
+            return ret;
+        }
+    }
+
     node->index = njs_generator_object_dest_index(vm, parser, node);
     if (nxt_slow_path(node->index == NJS_INDEX_ERROR)) {
         return NXT_ERROR;
@@ -1592,6 +1619,243 @@ njs_generate_array(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *node)
 }
 
 
+/*
+ * An object literal whose property names and values are all constants
+ * is built once at compile time and is copied by a single instruction.
+ * A duplicate name keeps its first position and takes the last value.
+ * Names handled by Object.prototype, like "__proto__", are assigned
+ * one by one to preserve their semantics.
+ */
+
+static nxt_int_t
+njs_generate_object_template(njs_vm_t *vm, njs_parser_t *parser,
+    njs_parser_node_t *node)
+{
+    nxt_int_t                     ret;
+    nxt_uint_t                    i, n, items;
+    nxt_lvlhsh_t                  hash;
+    njs_object_t                  *object;
+    njs_object_prop_t             *prop, *props;
+    njs_parser_node_t             *stmt, *name, **assign;
+    nxt_lvlhsh_query_t            lhq;
+    njs_object_template_t         *template;
+    njs_vmcode_object_template_t  *code;
+
+    object = &vm->shared->prototypes[NJS_PROTOTYPE_OBJECT].object;
+
+    lhq.proto = &njs_object_hash_proto;
+
+    n = 0;
+
+    for (stmt = node->left; stmt != NULL; stmt = stmt->left) {
+        name = stmt->right->left->right;
+
+        if (!njs_generator_constant(stmt->right->right)) {
+            return NXT_DECLINED;
+        }
+
+        if (name->token == NJS_TOKEN_STRING) {
+            njs_string_get(&name->u.value, &lhq.key);
+            lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
+
+            ret = nxt_lvlhsh_find(&object->shared_hash, &lhq);
+
+            if (ret == NXT_OK) {
+                prop = lhq.value;
+
+                if (prop->type == NJS_PROPERTY_HANDLER) {
+                    return NXT_DECLINED;
+                }
+            }
+
+        } else if (name->token != NJS_TOKEN_NUMBER) {
+            return NXT_DECLINED;
+        }
+
+        n++;
+    }
+
+    assign = nxt_mem_cache_alloc(vm->compile_pool,
+                                 n * sizeof(njs_parser_node_t *));
+    if (nxt_slow_path(assign == NULL)) {
+        return NXT_ERROR;
+    }
+
+    /* The statements are linked from the last property to the first one. */
+
+    i = n;
+
+    for (stmt = node->left; stmt != NULL; stmt = stmt->left) {
+        assign[--i] = stmt->right;
+    }
+
+    props = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t),
+                                n * sizeof(njs_object_prop_t));
+    if (nxt_slow_path(props == NULL)) {
+        return NXT_ERROR;
+    }
+
+    nxt_lvlhsh_init(&hash);
+
+    lhq.replace = 0;
+    lhq.pool = vm->compile_pool;
+
+    items = 0;
+
+    for (i = 0; i < n; i++) {
+        prop = &props[items];
+
+        ret = njs_primitive_value_to_string(vm, &prop->name,
+                                            &assign[i]->left->right->u.value);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NXT_ERROR;
+        }
+
+        ret = njs_generate_template_value(vm, parser, &prop->name);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NXT_ERROR;
+        }
+
+        ret = njs_generate_template_value(vm, parser,
+                                          &assign[i]->right->u.value);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NXT_ERROR;
+        }
+
+        njs_string_get(&prop->name, &lhq.key);
+        lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
+
+        ret = nxt_lvlhsh_find(&hash, &lhq);
+
+        if (ret == NXT_OK) {
+            prop = lhq.value;
+            prop->value = assign[i]->right->u.value;
+            continue;
+        }
+
+        prop->value = assign[i]->right->u.value;
+        prop->type = NJS_PROPERTY;
+        prop->enumerable = 1;
+        prop->writable = 1;
+        prop->configurable = 1;
+
+        lhq.value = prop;
+
+        ret = nxt_lvlhsh_insert(&hash, &lhq);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NXT_ERROR;
+        }
+
+        items++;
+    }
+
+    template = nxt_mem_cache_alloc(vm->mem_cache_pool,
+                                   sizeof(njs_object_template_t));
+    if (nxt_slow_path(template == NULL)) {
+        return NXT_ERROR;
+    }
+
+    template->properties = props;
+    template->items = items;
+
+    /* The object is complete after the instruction. */
+    node->left = NULL;
+
+    node->index = njs_generator_object_dest_index(vm, parser, node);
+    if (nxt_slow_path(node->index == NJS_INDEX_ERROR)) {
+        return NXT_ERROR;
+    }
+
+    njs_generate_code(parser, njs_vmcode_object_template_t, code);
+    code->code.operation = njs_vmcode_object_template;
+    code->code.operands = NJS_VMCODE_1OPERAND;
+    code->code.retval = NJS_VMCODE_RETVAL;
+    code->retval = node->index;
+    code->template = template;
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_generate_array_template(njs_vm_t *vm, njs_parser_t *parser,
+    njs_parser_node_t *node)
+{
+    uint32_t                     index;
+    nxt_uint_t                   i;
+    nxt_int_t                    ret;
+    njs_array_t                  *template;
+    njs_parser_node_t            *stmt;
+    njs_vmcode_array_template_t  *code;
+
+    for (stmt = node->left; stmt != NULL; stmt = stmt->left) {
+        if (!njs_generator_constant(stmt->right->right)) {
+            return NXT_DECLINED;
+        }
+    }
+
+    template = njs_array_alloc(vm, node->u.length, 0);
+    if (nxt_slow_path(template == NULL)) {
+        return NXT_ERROR;
+    }
+
+    /* Elisions leave holes in the array. */
+
+    for (i = 0; i < node->u.length; i++) {
+        template->start[i] = njs_value_invalid;
+    }
+
+    for (stmt = node->left; stmt != NULL; stmt = stmt->left) {
+        index = stmt->right->left->right->u.value.data.u.number;
+
+        ret = njs_generate_template_value(vm, parser,
+                                          &stmt->right->right->u.value);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NXT_ERROR;
+        }
+
+        template->start[index] = stmt->right->right->u.value;
+    }
+
+    /* The array is complete after the instruction. */
+    node->left = NULL;
+
+    node->index = njs_generator_object_dest_index(vm, parser, node);
+    if (nxt_slow_path(node->index == NJS_INDEX_ERROR)) {
+        return NXT_ERROR;
+    }
+
+    njs_generate_code(parser, njs_vmcode_array_template_t, code);
+    code->code.operation = njs_vmcode_array_template;
+    code->code.operands = NJS_VMCODE_1OPERAND;
+    code->code.retval = NJS_VMCODE_RETVAL;
+    code->retval = node->index;
+    code->template = template;
+
+    return NXT_OK;
+}
+
+
+/*
+ * Templates are shared by cloned VMs, so their long strings are made
+ * constants whose hashes are evaluated in advance and never cached
+ * lazily by njs_string_hash().
+ */
+
+static nxt_int_t
+njs_generate_template_value(njs_vm_t *vm, njs_parser_t *parser,
+    njs_value_t *value)
+{
+    if (njs_is_string(value) && value->short_string.size == NJS_STRING_LONG) {
+        if (njs_value_index(vm, parser, value) == NJS_INDEX_NONE) {
+            return NXT_ERROR;
+        }
+    }
+
+    return NXT_OK;
+}
+
+
 static nxt_int_t
 njs_generate_function(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node)
@@ -2574,7 +2838,7 @@ njs_generator_temp_index_get(njs_vm_t *vm, njs_parser_t *parser,
 
     } else {
         value = nxt_array_add(scope->values[0], &njs_array_mem_proto,
-                              vm->mem_cache_pool);
+                              vm->compile_pool);
         if (nxt_slow_path(value == NULL)) {
             return NJS_INDEX_ERROR;
         }
@@ -2630,7 +2894,7 @@ njs_generator_index_release(njs_vm_t *vm, njs_parser_t *parser,
 
     if (cache == NULL) {
         cache = nxt_array_create(4, sizeof(njs_value_t *),
-                                 &njs_array_mem_proto, vm->mem_cache_pool);
+                                 &njs_array_mem_proto, vm->compile_pool);
         if (nxt_slow_path(cache == NULL)) {
             return NXT_ERROR;
         }
@@ -2638,7 +2902,7 @@ njs_generator_index_release(njs_vm_t *vm, njs_parser_t *parser,
         parser->index_cache = cache;
     }
 
-    last = nxt_array_add(cache, &njs_array_mem_proto, vm->mem_cache_pool);
+    last = nxt_array_add(cache, &njs_array_mem_proto, vm->compile_pool);
     if (nxt_fast_path(last != NULL)) {
         *last = index;
         return NXT_OK;
@@ -100,7 +100,7 @@ static const u_char *njs_json_parse_object(njs_json_parse_ctx_t *ctx,
 static const u_char *njs_json_parse_array(njs_json_parse_ctx_t *ctx,
     njs_value_t *value, const u_char *p);
 static const u_char *njs_json_parse_string(njs_json_parse_ctx_t *ctx,
-    njs_value_t *value, const u_char *p);
+    njs_value_t *value, const u_char *p, nxt_bool_t name);
 static const u_char *njs_json_parse_number(njs_json_parse_ctx_t *ctx,
     njs_value_t *value, const u_char *p);
 nxt_inline uint32_t njs_json_unicode(const u_char *p);
@@ -344,7 +344,7 @@ njs_json_parse_value(njs_json_parse_ctx_t *ctx, njs_value_t *value,
         return njs_json_parse_array(ctx, value, p);
 
     case '"':
-        return njs_json_parse_string(ctx, value, p);
+        return njs_json_parse_string(ctx, value, p, 0);
 
     case 't':
         if (nxt_fast_path(ctx->end - p >= 4 && memcmp(p, "true", 4) == 0)) {
@@ -392,7 +392,7 @@ njs_json_parse_object(njs_json_parse_ctx_t *ctx, njs_value_t *value,
 {
     nxt_int_t           ret;
     njs_object_t        *object;
-    njs_value_t         *prop_name, *prop_value;
+    njs_value_t         prop_name, *prop_value;
     njs_object_prop_t   *prop;
     nxt_lvlhsh_query_t  lhq;
 
@@ -427,12 +427,7 @@ njs_json_parse_object(njs_json_parse_ctx_t *ctx, njs_value_t *value,
             goto error_token;
         }
 
-        prop_name = nxt_mem_cache_alloc(ctx->pool, sizeof(njs_value_t));
-        if (nxt_slow_path(prop_name == NULL)) {
-            goto memory_error;
-        }
-
-        p = njs_json_parse_string(ctx, prop_name, p);
+        p = njs_json_parse_string(ctx, &prop_name, p, 1);
         if (nxt_slow_path(p == NULL)) {
             /* The exception is set by the called function. */
             return NULL;
@@ -459,13 +454,13 @@ njs_json_parse_object(njs_json_parse_ctx_t *ctx, njs_value_t *value,
             return NULL;
         }
 
-        prop = njs_object_prop_alloc(ctx->vm, prop_name, prop_value, 1);
+        prop = njs_object_prop_alloc(ctx->vm, &prop_name, prop_value, 1);
         if (nxt_slow_path(prop == NULL)) {
             goto memory_error;
         }
 
-        njs_string_get(prop_name, &lhq.key);
-        lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
+        njs_string_get(&prop_name, &lhq.key);
+        lhq.key_hash = njs_string_hash(&prop_name, &lhq.key);
         lhq.value = prop;
         lhq.replace = 1;
         lhq.pool = ctx->pool;
@@ -608,7 +603,7 @@ error_end:
 
 static const u_char *
 njs_json_parse_string(njs_json_parse_ctx_t *ctx, njs_value_t *value,
-    const u_char *p)
+    const u_char *p, nxt_bool_t name)
 {
     u_char        ch, *s, *dst;
     size_t        size, surplus;
@@ -807,7 +802,14 @@ njs_json_parse_string(njs_json_parse_ctx_t *ctx, njs_value_t *value,
         length = 0;
     }
 
-    ret = njs_string_create(ctx->vm, value, (u_char *) start, size, length);
+    if (name) {
+        ret = njs_string_atom(ctx->vm, value, (u_char *) start, size, length);
+
+    } else {
+        ret = njs_string_create(ctx->vm, value, (u_char *) start, size,
+                                length);
+    }
+
     if (nxt_slow_path(ret != NXT_OK)) {
         return NULL;
     }
@@ -18,6 +18,7 @@ struct njs_lexer_multi_s {
 };
 
 
+nxt_inline uint64_t njs_lexer_word_load(const u_char *p);
 static njs_token_t njs_lexer_next_token(njs_lexer_t *lexer);
 static njs_token_t njs_lexer_word(njs_lexer_t *lexer, u_char c);
 static njs_token_t njs_lexer_string(njs_lexer_t *lexer, u_char quote);
@@ -28,6 +29,24 @@ static njs_token_t njs_lexer_division(njs_lexer_t *lexer,
     njs_token_t token);
 
 
+/*
+ * Long runs of spaces and bodies of strings and comments are skipped
+ * eight bytes at a time.  njs_swar_has() tests whether any byte of
+ * a word is equal to the character.
+ */
+
+#define NJS_SWAR_ONES     0x0101010101010101ULL
+#define NJS_SWAR_HIGH     0x8080808080808080ULL
+
+#define njs_swar(c)       ((uint64_t) (c) * NJS_SWAR_ONES)
+
+#define njs_swar_zero(w)                                                      \
+    (((w) - NJS_SWAR_ONES) & ~(w) & NJS_SWAR_HIGH)
+
+#define njs_swar_has(w, c)                                                    \
+    (njs_swar_zero((w) ^ njs_swar(c)) != 0)
+
+
 static const uint8_t  njs_tokens[256]  nxt_aligned(64) = {
 
                 NJS_TOKEN_ILLEGAL,           NJS_TOKEN_ILLEGAL,
@@ -305,6 +324,15 @@ njs_lexer_next_token(njs_lexer_t *lexer)
         switch (token) {
 
         case NJS_TOKEN_SPACE:
+            if (lexer->start < lexer->end && lexer->start[0] == ' ') {
+
+                while (lexer->end - lexer->start >= 8
+                       && njs_lexer_word_load(lexer->start) == njs_swar(' '))
+                {
+                    lexer->start += 8;
+                }
+            }
+
             lexer->text.start = lexer->start;
             continue;
 
@@ -478,10 +506,22 @@ njs_lexer_word(njs_lexer_t *lexer, u_char c)
 }
 
 
+nxt_inline uint64_t
+njs_lexer_word_load(const u_char *p)
+{
+    uint64_t  w;
+
+    memcpy(&w, p, sizeof(uint64_t));
+
+    return w;
+}
+
+
 static njs_token_t
 njs_lexer_string(njs_lexer_t *lexer, u_char quote)
 {
     u_char      *p, c;
+    uint64_t    w;
     nxt_bool_t  escape;
 
     escape = 0;
@@ -490,6 +530,15 @@ njs_lexer_string(njs_lexer_t *lexer, u_char quote)
 
     while (p < lexer->end) {
 
+        if (lexer->end - p >= 8) {
+            w = njs_lexer_word_load(p);
+
+            if (!njs_swar_has(w, quote) && !njs_swar_has(w, '\\')) {
+                p += 8;
+                continue;
+            }
+        }
+
         c = *p++;
 
         if (c == '\\') {
@@ -647,7 +696,8 @@ njs_lexer_multi(njs_lexer_t *lexer, njs_token_t token, nxt_uint_t n,
 static njs_token_t
 njs_lexer_division(njs_lexer_t *lexer, njs_token_t token)
 {
-    u_char  c, *p;
+    u_char    c, *p;
+    uint64_t  w;
 
     if (lexer->start < lexer->end) {
         c = lexer->start[0];
@@ -656,32 +706,40 @@ njs_lexer_division(njs_lexer_t *lexer, njs_token_t token)
             token = NJS_TOKEN_END;
             lexer->start++;
 
-            for (p = lexer->start; p < lexer->end; p++) {
+            p = memchr(lexer->start, '\n', lexer->end - lexer->start);
 
-                if (*p == '\n') {
-                    lexer->start = p + 1;
-                    lexer->line++;
-                    return NJS_TOKEN_LINE_END;
-                }
+            if (p != NULL) {
+                lexer->start = p + 1;
+                lexer->line++;
+                return NJS_TOKEN_LINE_END;
             }
 
         } else if (c == '*') {
             lexer->start++;
 
-            for (p = lexer->start; p < lexer->end; p++) {
+            p = lexer->start;
+
+            while (p < lexer->end) {
 
-                if (*p == '\n') {
+                if (lexer->end - p >= 8) {
+                    w = njs_lexer_word_load(p);
+
+                    if (!njs_swar_has(w, '*') && !njs_swar_has(w, '\n')) {
+                        p += 8;
+                        continue;
+                    }
+                }
+
+                c = *p++;
+
+                if (c == '\n') {
                     lexer->line++;
                     continue;
                 }
 
-                if (*p == '*') {
-                    p++;
-
-                    if (p < lexer->end && *p == '/') {
-                        lexer->start = p + 1;
-                        return NJS_TOKEN_AGAIN;
-                    }
+                if (c == '*' && p < lexer->end && *p == '/') {
+                    lexer->start = p + 1;
+                    return NJS_TOKEN_AGAIN;
                 }
             }
 
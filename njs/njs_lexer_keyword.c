@@ -127,79 +127,85 @@ static const njs_keyword_t  njs_keywords[] = {
 };
 
 
-static nxt_int_t
-njs_keyword_hash_test(nxt_lvlhsh_query_t *lhq, void *data)
-{
-    njs_keyword_t  *keyword;
-
-    keyword = data;
-
-    if (nxt_strstr_eq(&lhq->key, &keyword->name)) {
-        return NXT_OK;
-    }
-
-    return NXT_DECLINED;
-}
-
+/*
+ * A perfect hash over the keywords.  The djb hash of an identifier is
+ * computed by the lexer anyway, it is scrambled by a multiplier to get
+ * a slot of the table, the slot holds an index of the only keyword which
+ * can have the hash, or zero.  The multiplier has been found by search
+ * for the current keywords.  If the keywords are changed, a multiplier
+ * and the table should be generated again, njs_unit_test tests that
+ * every keyword is recognized.
+ */
 
-const nxt_lvlhsh_proto_t  njs_keyword_hash_proto
-    nxt_aligned(64) =
-{
-    NXT_LVLHSH_DEFAULT,
-    0,
-    njs_keyword_hash_test,
-    njs_lvlhsh_alloc,
-    njs_lvlhsh_free,
+#define NJS_KEYWORD_HASH_MULTIPLIER  0x772bfb49
+#define NJS_KEYWORD_HASH_BITS        9
+
+#define njs_keyword_hash_slot(key_hash)                                       \
+    ((uint32_t) ((key_hash) * NJS_KEYWORD_HASH_MULTIPLIER)                    \
+     >> (32 - NJS_KEYWORD_HASH_BITS))
+
+
+static const uint8_t  njs_keyword_hash[1 << NJS_KEYWORD_HASH_BITS] = {
+     0,  0,  0,  0,  0,  0, 73,  0,  0,  0,  0, 47,  0, 49,  0, 92,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    53,  0,  0,  0,  4,  0,  0,  0, 89,  0,  0,  0,  0,  6,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 75,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  2,  0,  0, 91,  0,  9, 37,  0, 82,  0,  0,
+     0,  0, 26,  0,  0,  0,  0, 17,  0, 90,  0,  0,  0,  0,  0,  0,
+     0, 18, 55,  0, 58,  0, 43,  0,  0,  0,  0, 20, 78,  0, 93,  0,
+     0,  0,  0,  0,  0,  1,  0, 63, 87,  0, 44,  0,  0, 96, 40, 29,
+     0,  0,  0,  0,  7,  0,  0,  0,  0, 11, 88,  0,  0, 84, 12,  0,
+     0,  0,  0,  0, 65,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 59,
+     0,  0,  0,  0,  0,  0,  0,  0,  0, 25, 23, 66,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0, 64, 60,  0,  0,  0,  0,  0,  0,  0,
+     0,  3,  0,  0,  0,  0, 77,  0, 41,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0, 32,  0,  0,  0,  0,  0,  0,  8,  0,  0,
+    48,  0, 94,  0,  0,  0,  0, 39,  0,  0,  0,  0,  0,  0,  0,  0,
+    51,  0, 46,  0, 72, 71,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  5,  0,  0,  0,  0,  0,  0,
+     0, 31,  0,  0,  0,  0,  0,  0, 19,  0,  0, 50,  0, 86,  0,  0,
+     0,  0, 52,  0,  0, 10,  0,  0,  0,  0, 76,  0,  0,  0,  0,  0,
+     0,  0,  0, 34,  0, 56,  0,  0, 35,  0,  0,  0,  0, 24,  0,  0,
+     0,  0,  0,  0, 70,  0,  0,  0,  0, 22,  0,  0,  0, 74,  0,  0,
+     0,  0, 28,  0,  0, 45,  0,  0,  0,  0,  0,  0,  0,  0, 38,  0,
+     0, 69,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0, 42, 79,  0,  0,  0, 30,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0, 54,  0,  0,  0,  0,  0,  0,  0,  0, 80,
+     0,  0,  0,  0, 85, 95,  0,  0,  0,  0, 27,  0,  0,  0,  0,  0,
+     0, 83,  0,  0, 61,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0, 16,  0,  0,  0,  0,  0,  0,  0,  0, 62,  0,  0,
+     0,  0,  0,  0,  0, 14,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0, 81,  0, 67,  0,  0,  0,  0,  0, 68,  0,
+    21,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    57,  0,  0, 33,  0,  0,  0, 15,  0,  0, 13,  0,  0, 36,  0,  0,
 };
 
 
-nxt_int_t
-njs_lexer_keywords_init(nxt_mem_cache_pool_t *mcp, nxt_lvlhsh_t *hash)
+const njs_keyword_t *
+njs_lexer_keywords(nxt_uint_t *n)
 {
-    nxt_uint_t           n;
-    nxt_lvlhsh_query_t   lhq;
-    const njs_keyword_t  *keyword;
+    *n = nxt_nitems(njs_keywords);
 
-    keyword = njs_keywords;
-    n = nxt_nitems(njs_keywords);
-
-    lhq.replace = 0;
-    lhq.proto = &njs_keyword_hash_proto;
-    lhq.pool = mcp;
-
-    do {
-        lhq.key_hash = nxt_djb_hash(keyword->name.start, keyword->name.length);
-        lhq.key = keyword->name;
-        lhq.value = (void *) keyword;
-
-        if (nxt_slow_path(nxt_lvlhsh_insert(hash, &lhq) != NXT_OK)) {
-            return NXT_ERROR;
-        }
-
-        keyword++;
-        n--;
-
-    } while (n != 0);
-
-    return NXT_OK;
+    return njs_keywords;
 }
 
 
 njs_token_t
 njs_lexer_keyword(njs_lexer_t *lexer)
 {
-    njs_keyword_t       *keyword;
-    nxt_lvlhsh_query_t  lhq;
+    nxt_uint_t           n;
+    const njs_keyword_t  *keyword;
 
-    lhq.key_hash = lexer->key_hash;
-    lhq.key = lexer->text;
-    lhq.proto = &njs_keyword_hash_proto;
+    n = njs_keyword_hash[njs_keyword_hash_slot(lexer->key_hash)];
 
-    if (nxt_lvlhsh_find(&lexer->keywords_hash, &lhq) == NXT_OK) {
-        keyword = lhq.value;
-        lexer->number = keyword->number;
+    if (n != 0) {
+        keyword = &njs_keywords[n - 1];
 
-        return keyword->token;
+        if (nxt_strstr_eq(&lexer->text, &keyword->name)) {
+            lexer->number = keyword->number;
+
+            return keyword->token;
+        }
     }
 
     return NJS_TOKEN_NAME;
@@ -39,6 +39,7 @@ const nxt_lvlhsh_proto_t  njs_modules_hash_proto
 njs_ret_t njs_module_require(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
+    nxt_int_t           ret;
     njs_module_t        *module;
     nxt_lvlhsh_query_t  lhq;
 
@@ -51,21 +52,56 @@ njs_ret_t njs_module_require(njs_vm_t *vm, njs_value_t *args,
     lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
     lhq.proto = &njs_modules_hash_proto;
 
-    if (nxt_lvlhsh_find(&vm->modules_hash, &lhq) == NXT_OK) {
+    if (vm->cloned
+        && nxt_lvlhsh_find(&vm->cloned_modules_hash, &lhq) == NXT_OK)
+    {
         module = lhq.value;
-        module->object.__proto__ = &vm->prototypes[NJS_PROTOTYPE_OBJECT].object;
+        goto found;
+    }
 
-        vm->retval.data.u.object = &module->object;
-        vm->retval.type = NJS_OBJECT;
-        vm->retval.data.truth = 1;
+    if (nxt_lvlhsh_find(&vm->modules_hash, &lhq) != NXT_OK) {
+        njs_error(vm, "Cannot find module '%.*s'",
+                  (int) lhq.key.length, lhq.key.start);
 
-        return NXT_OK;
+        return NJS_ERROR;
+    }
+
+    module = lhq.value;
+
+    if (vm->cloned) {
+        /*
+         * The module object of the parent VM must not be changed
+         * because it is shared with other cloned VMs.
+         */
+
+        module = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_module_t));
+        if (nxt_slow_path(module == NULL)) {
+            njs_memory_error(vm);
+            return NJS_ERROR;
+        }
+
+        *module = *(njs_module_t *) lhq.value;
+
+        lhq.replace = 0;
+        lhq.value = module;
+        lhq.pool = vm->mem_cache_pool;
+
+        ret = nxt_lvlhsh_insert(&vm->cloned_modules_hash, &lhq);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            njs_internal_error(vm, "lvlhsh insert failed");
+            return NJS_ERROR;
+        }
     }
 
-    njs_error(vm, "Cannot find module '%.*s'",
-              (int) lhq.key.length, lhq.key.start);
+    module->object.__proto__ = &vm->prototypes[NJS_PROTOTYPE_OBJECT].object;
+
+found:
+
+    vm->retval.data.u.object = &module->object;
+    vm->retval.type = NJS_OBJECT;
+    vm->retval.data.truth = 1;
 
-    return NJS_ERROR;
+    return NXT_OK;
 }
 
 
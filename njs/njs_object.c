@@ -163,6 +163,10 @@ njs_object_hash_test(nxt_lvlhsh_query_t *lhq, void *data)
         }
 
         start = prop->name.long_string.data->start;
+
+        if (start == lhq->key.start) {
+            return NXT_OK;
+        }
     }
 
     if (memcmp(start, lhq->key.start, lhq->key.length) == 0) {
@@ -358,14 +362,16 @@ njs_property_query(njs_vm_t *vm, njs_property_query_t *pq, njs_value_t *object,
         if (nxt_fast_path(ret == NXT_OK)) {
 
             njs_string_get(&pq->value, &pq->lhq.key);
-            pq->lhq.key_hash = hash(pq->lhq.key.start, pq->lhq.key.length);
 
             if (obj == NULL) {
+                pq->lhq.key_hash = hash(pq->lhq.key.start, pq->lhq.key.length);
                 pq->lhq.proto = &njs_extern_hash_proto;
 
                 return NJS_EXTERNAL_VALUE;
             }
 
+            pq->lhq.key_hash = njs_string_hash(&pq->value, &pq->lhq.key);
+
             return njs_object_property_query(vm, pq, object, obj);
         }
 
@@ -1856,7 +1862,7 @@ njs_object_prototype_has_own_property(njs_vm_t *vm, njs_value_t *args,
         }
 
         njs_string_get(prop, &lhq.key);
-        lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
+        lhq.key_hash = njs_string_hash(prop, &lhq.key);
         lhq.proto = &njs_object_hash_proto;
 
         ret = nxt_lvlhsh_find(&value->data.u.object->hash, &lhq);
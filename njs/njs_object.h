@@ -62,6 +62,17 @@ struct njs_object_init_s {
 };
 
 
+/*
+ * An object literal with constant property names and values is created
+ * by the generator once, the properties are unique and stored in order
+ * of their first appearance in the literal.
+ */
+struct njs_object_template_s {
+    njs_object_prop_t           *properties;
+    nxt_uint_t                  items;
+};
+
+
 njs_object_t *njs_object_alloc(njs_vm_t *vm);
 njs_object_t *njs_object_value_copy(njs_vm_t *vm, njs_value_t *value);
 njs_object_t *njs_object_value_alloc(njs_vm_t *vm, const njs_value_t *value,
@@ -78,53 +78,17 @@ static njs_token_t njs_parser_unexpected_token(njs_vm_t *vm,
 
 
 njs_parser_node_t *
-njs_parser(njs_vm_t *vm, njs_parser_t *parser, njs_parser_t *prev)
+njs_parser(njs_vm_t *vm, njs_parser_t *parser)
 {
-    njs_ret_t           ret;
-    njs_token_t         token;
-    nxt_lvlhsh_t        *variables, *prev_variables;
-    njs_variable_t      *var;
-    njs_parser_node_t   *node;
-    nxt_lvlhsh_each_t   lhe;
-    nxt_lvlhsh_query_t  lhq;
+    njs_ret_t          ret;
+    njs_token_t        token;
+    njs_parser_node_t  *node;
 
     ret = njs_parser_scope_begin(vm, parser, NJS_SCOPE_GLOBAL);
     if (nxt_slow_path(ret != NXT_OK)) {
         return NULL;
     }
 
-    if (prev != NULL) {
-        /*
-         * Copy the global scope variables from the previous
-         * iteration of the accumulative mode.
-         */
-        nxt_lvlhsh_each_init(&lhe, &njs_variables_hash_proto);
-
-        lhq.proto = &njs_variables_hash_proto;
-        lhq.replace = 0;
-        lhq.pool = vm->mem_cache_pool;
-
-        variables = &parser->scope->variables;
-        prev_variables = &prev->scope->variables;
-
-        for ( ;; ) {
-            var = nxt_lvlhsh_each(prev_variables, &lhe);
-
-            if (var == NULL) {
-                break;
-            }
-
-            lhq.value = var;
-            lhq.key = var->name;
-            lhq.key_hash = nxt_djb_hash(var->name.start, var->name.length);
-
-            ret = nxt_lvlhsh_insert(variables, &lhq);
-            if (nxt_slow_path(ret != NXT_OK)) {
-                return NULL;
-            }
-        }
-    }
-
     token = njs_parser_token(parser);
 
     while (token != NJS_TOKEN_END) {
@@ -187,7 +151,7 @@ njs_parser_scope_begin(njs_vm_t *vm, njs_parser_t *parser, njs_scope_t type)
         }
     }
 
-    scope = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_parser_scope_t));
+    scope = nxt_mem_cache_alloc(vm->compile_pool, sizeof(njs_parser_scope_t));
     if (nxt_slow_path(scope == NULL)) {
         return NXT_ERROR;
     }
@@ -219,7 +183,7 @@ njs_parser_scope_begin(njs_vm_t *vm, njs_parser_t *parser, njs_scope_t type)
 
     if (scope->type < NJS_SCOPE_BLOCK) {
         values = nxt_array_create(4, sizeof(njs_value_t), &njs_array_mem_proto,
-                                  vm->mem_cache_pool);
+                                  vm->compile_pool);
         if (nxt_slow_path(values == NULL)) {
             return NXT_ERROR;
         }
@@ -588,7 +552,7 @@ njs_parser_function_create(njs_vm_t *vm, njs_parser_t *parent)
 {
     njs_parser_t  *parser;
 
-    parser = nxt_mem_cache_zalloc(vm->mem_cache_pool, sizeof(njs_parser_t));
+    parser = nxt_mem_cache_zalloc(vm->compile_pool, sizeof(njs_parser_t));
     if (nxt_slow_path(parser == NULL)) {
         return NULL;
     }
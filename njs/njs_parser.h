@@ -219,8 +219,6 @@ typedef struct {
     nxt_str_t                       text;
     double                          number;
 
-    nxt_lvlhsh_t                    keywords_hash;
-
     u_char                          *start;
     u_char                          *end;
 } njs_lexer_t;
@@ -286,7 +284,7 @@ struct njs_parser_node_s {
 
 
 #define njs_parser_node_alloc(vm)                                             \
-    nxt_mem_cache_zalloc((vm)->mem_cache_pool, sizeof(njs_parser_node_t))
+    nxt_mem_cache_zalloc((vm)->compile_pool, sizeof(njs_parser_node_t))
 
 
 typedef struct njs_parser_patch_s   njs_parser_patch_t;
@@ -357,14 +355,12 @@ typedef struct {
 
 
 njs_token_t njs_lexer_token(njs_lexer_t *lexer);
-nxt_int_t njs_lexer_keywords_init(nxt_mem_cache_pool_t *mcp,
-    nxt_lvlhsh_t *hash);
+const njs_keyword_t *njs_lexer_keywords(nxt_uint_t *n);
 njs_token_t njs_lexer_keyword(njs_lexer_t *lexer);
 
 njs_value_t *njs_parser_external(njs_vm_t *vm, njs_parser_t *parser);
 
-njs_parser_node_t *njs_parser(njs_vm_t *vm, njs_parser_t *parser,
-    njs_parser_t *prev);
+njs_parser_node_t *njs_parser(njs_vm_t *vm, njs_parser_t *parser);
 njs_token_t njs_parser_arguments(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *parent);
 njs_token_t njs_parser_expression(njs_vm_t *vm, njs_parser_t *parser,
@@ -402,7 +398,4 @@ nxt_int_t njs_generate_scope(njs_vm_t *vm, njs_parser_t *parser,
     } while (0)
 
 
-extern const nxt_lvlhsh_proto_t  njs_keyword_hash_proto;
-
-
 #endif /* _NJS_PARSER_H_INCLUDED_ */
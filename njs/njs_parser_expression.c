@@ -12,45 +12,21 @@ typedef struct {
     njs_token_t                    token;
     njs_vmcode_operation_t         operation;
     size_t                         size;
+    nxt_uint_t                     precedence;
 } njs_parser_operation_t;
 
 
-typedef struct njs_parser_expression_s  njs_parser_expression_t;
-
-struct njs_parser_expression_s {
-    njs_token_t                    (*next)(njs_vm_t *,
-                                       njs_parser_t *,
-                                       const njs_parser_expression_t *,
-                                       njs_token_t);
-    const njs_parser_expression_t  *expression;
-    nxt_uint_t                     count;
-
-#if (NXT_SUNC)
-    /*
-     * SunC supports C99 flexible array members but does not allow
-     * static struct's initialization with arbitrary number of members.
-     */
-    njs_parser_operation_t         op[6];
-#else
-    njs_parser_operation_t         op[];
-#endif
-};
+#define NJS_PARSER_BINARY_PRECEDENCES  10
 
 
-static njs_token_t njs_parser_any_expression(njs_vm_t *vm,
-    njs_parser_t *parser, const njs_parser_expression_t *expr,
-    njs_token_t token);
 static njs_token_t njs_parser_conditional_expression(njs_vm_t *vm,
     njs_parser_t *parser, njs_token_t token);
 static njs_token_t njs_parser_binary_expression(njs_vm_t *vm,
-    njs_parser_t *parser, const njs_parser_expression_t *expr,
-    njs_token_t token);
+    njs_parser_t *parser, njs_token_t token);
 static njs_token_t njs_parser_exponential_expression(njs_vm_t *vm,
-    njs_parser_t *parser, const njs_parser_expression_t *expr,
-    njs_token_t token);
+    njs_parser_t *parser, njs_token_t token);
 static njs_token_t njs_parser_unary_expression(njs_vm_t *vm,
-    njs_parser_t *parser, const njs_parser_expression_t *expr,
-    njs_token_t token);
+    njs_parser_t *parser, njs_token_t token);
 static njs_token_t njs_parser_inc_dec_expression(njs_vm_t *vm,
     njs_parser_t *parser, njs_token_t token);
 static njs_token_t njs_parser_post_inc_dec_expression(njs_vm_t *vm,
@@ -65,176 +41,158 @@ static njs_token_t njs_parser_property_brackets(njs_vm_t *vm,
     njs_parser_t *parser, njs_token_t token);
 
 
-static const njs_parser_expression_t
-    njs_parser_factor_expression =
-{
-    njs_parser_exponential_expression,
-    NULL,
-    3, {
-        { NJS_TOKEN_MULTIPLICATION, njs_vmcode_multiplication,
-          sizeof(njs_vmcode_3addr_t) },
-        { NJS_TOKEN_DIVISION, njs_vmcode_division,
-          sizeof(njs_vmcode_3addr_t) },
-        { NJS_TOKEN_REMAINDER, njs_vmcode_remainder,
-          sizeof(njs_vmcode_3addr_t) },
-    }
-};
-
+/*
+ * The table is indexed by tokens from NJS_TOKEN_EQUAL to
+ * NJS_TOKEN_INSTANCEOF, tokens which are not binary operators
+ * have NJS_TOKEN_ILLEGAL.
+ */
 
-static const njs_parser_expression_t
-    njs_parser_addition_expression =
-{
-    njs_parser_binary_expression,
-    &njs_parser_factor_expression,
-    2, {
-        { NJS_TOKEN_ADDITION, njs_vmcode_addition,
-          sizeof(njs_vmcode_3addr_t) },
-        { NJS_TOKEN_SUBSTRACTION, njs_vmcode_substraction,
-          sizeof(njs_vmcode_3addr_t) },
-    }
+#define NJS_PARSER_FIRST_BINARY  NJS_TOKEN_EQUAL
+#define NJS_PARSER_LAST_BINARY   NJS_TOKEN_INSTANCEOF
+
+
+static const njs_parser_operation_t  njs_parser_binary_operations[] = {
+
+    { NJS_TOKEN_EQUAL, njs_vmcode_equal,
+      sizeof(njs_vmcode_3addr_t), 6 },
+    { NJS_TOKEN_STRICT_EQUAL, njs_vmcode_strict_equal,
+      sizeof(njs_vmcode_3addr_t), 6 },
+    { NJS_TOKEN_NOT_EQUAL, njs_vmcode_not_equal,
+      sizeof(njs_vmcode_3addr_t), 6 },
+    { NJS_TOKEN_STRICT_NOT_EQUAL, njs_vmcode_strict_not_equal,
+      sizeof(njs_vmcode_3addr_t), 6 },
+
+    { NJS_TOKEN_ADDITION, njs_vmcode_addition,
+      sizeof(njs_vmcode_3addr_t), 9 },
+    { NJS_TOKEN_ILLEGAL, NULL, 0, 0 },          /* NJS_TOKEN_UNARY_PLUS */
+    { NJS_TOKEN_ILLEGAL, NULL, 0, 0 },          /* NJS_TOKEN_INCREMENT */
+    { NJS_TOKEN_ILLEGAL, NULL, 0, 0 },          /* NJS_TOKEN_POST_INCREMENT */
+
+    { NJS_TOKEN_SUBSTRACTION, njs_vmcode_substraction,
+      sizeof(njs_vmcode_3addr_t), 9 },
+    { NJS_TOKEN_ILLEGAL, NULL, 0, 0 },          /* NJS_TOKEN_UNARY_NEGATION */
+    { NJS_TOKEN_ILLEGAL, NULL, 0, 0 },          /* NJS_TOKEN_DECREMENT */
+    { NJS_TOKEN_ILLEGAL, NULL, 0, 0 },          /* NJS_TOKEN_POST_DECREMENT */
+
+    { NJS_TOKEN_MULTIPLICATION, njs_vmcode_multiplication,
+      sizeof(njs_vmcode_3addr_t), 10 },
+    { NJS_TOKEN_ILLEGAL, NULL, 0, 0 },          /* NJS_TOKEN_EXPONENTIATION */
+    { NJS_TOKEN_DIVISION, njs_vmcode_division,
+      sizeof(njs_vmcode_3addr_t), 10 },
+    { NJS_TOKEN_REMAINDER, njs_vmcode_remainder,
+      sizeof(njs_vmcode_3addr_t), 10 },
+
+    { NJS_TOKEN_LESS, njs_vmcode_less,
+      sizeof(njs_vmcode_3addr_t), 7 },
+    { NJS_TOKEN_LESS_OR_EQUAL, njs_vmcode_less_or_equal,
+      sizeof(njs_vmcode_3addr_t), 7 },
+    { NJS_TOKEN_LEFT_SHIFT, njs_vmcode_left_shift,
+      sizeof(njs_vmcode_3addr_t), 8 },
+
+    { NJS_TOKEN_GREATER, njs_vmcode_greater,
+      sizeof(njs_vmcode_3addr_t), 7 },
+    { NJS_TOKEN_GREATER_OR_EQUAL, njs_vmcode_greater_or_equal,
+      sizeof(njs_vmcode_3addr_t), 7 },
+    { NJS_TOKEN_RIGHT_SHIFT, njs_vmcode_right_shift,
+      sizeof(njs_vmcode_3addr_t), 8 },
+    { NJS_TOKEN_UNSIGNED_RIGHT_SHIFT, njs_vmcode_unsigned_right_shift,
+      sizeof(njs_vmcode_3addr_t), 8 },
+
+    { NJS_TOKEN_BITWISE_OR, njs_vmcode_bitwise_or,
+      sizeof(njs_vmcode_3addr_t), 3 },
+    { NJS_TOKEN_LOGICAL_OR, njs_vmcode_test_if_true,
+      sizeof(njs_vmcode_test_jump_t) + sizeof(njs_vmcode_move_t), 1 },
+
+    { NJS_TOKEN_BITWISE_XOR, njs_vmcode_bitwise_xor,
+      sizeof(njs_vmcode_3addr_t), 4 },
+
+    { NJS_TOKEN_BITWISE_AND, njs_vmcode_bitwise_and,
+      sizeof(njs_vmcode_3addr_t), 5 },
+    { NJS_TOKEN_LOGICAL_AND, njs_vmcode_test_if_false,
+      sizeof(njs_vmcode_test_jump_t) + sizeof(njs_vmcode_move_t), 2 },
+
+    { NJS_TOKEN_ILLEGAL, NULL, 0, 0 },          /* NJS_TOKEN_BITWISE_NOT */
+    { NJS_TOKEN_ILLEGAL, NULL, 0, 0 },          /* NJS_TOKEN_LOGICAL_NOT */
+
+    { NJS_TOKEN_IN, njs_vmcode_property_in,
+      sizeof(njs_vmcode_3addr_t), 7 },
+    { NJS_TOKEN_INSTANCEOF, njs_vmcode_instance_of,
+      sizeof(njs_vmcode_3addr_t), 7 },
 };
 
 
-static const njs_parser_expression_t
-    njs_parser_bitwise_shift_expression =
-{
-    njs_parser_binary_expression,
-    &njs_parser_addition_expression,
-    3, {
-        { NJS_TOKEN_LEFT_SHIFT, njs_vmcode_left_shift,
-          sizeof(njs_vmcode_3addr_t) },
-        { NJS_TOKEN_RIGHT_SHIFT, njs_vmcode_right_shift,
-          sizeof(njs_vmcode_3addr_t) },
-        { NJS_TOKEN_UNSIGNED_RIGHT_SHIFT, njs_vmcode_unsigned_right_shift,
-          sizeof(njs_vmcode_3addr_t) },
-    }
-};
+/* The table must be changed together with the tokens. */
 
+nxt_static_assert(njs_parser_binary_operations,
+    nxt_nitems(njs_parser_binary_operations)
+    == NJS_PARSER_LAST_BINARY - NJS_PARSER_FIRST_BINARY + 1);
 
-static const njs_parser_expression_t
-    njs_parser_relational_expression =
-{
-    njs_parser_binary_expression,
-    &njs_parser_bitwise_shift_expression,
-    6, {
-        { NJS_TOKEN_LESS, njs_vmcode_less,
-          sizeof(njs_vmcode_3addr_t) },
-        { NJS_TOKEN_LESS_OR_EQUAL, njs_vmcode_less_or_equal,
-          sizeof(njs_vmcode_3addr_t) },
-        { NJS_TOKEN_GREATER, njs_vmcode_greater,
-          sizeof(njs_vmcode_3addr_t) },
-        { NJS_TOKEN_GREATER_OR_EQUAL, njs_vmcode_greater_or_equal,
-          sizeof(njs_vmcode_3addr_t) },
-        { NJS_TOKEN_IN, njs_vmcode_property_in,
-          sizeof(njs_vmcode_3addr_t) },
-        { NJS_TOKEN_INSTANCEOF, njs_vmcode_instance_of,
-          sizeof(njs_vmcode_3addr_t) },
-    }
-};
 
-
-static const njs_parser_expression_t
-    njs_parser_equality_expression =
-{
-    njs_parser_binary_expression,
-    &njs_parser_relational_expression,
-    4, {
-        { NJS_TOKEN_EQUAL, njs_vmcode_equal,
-          sizeof(njs_vmcode_3addr_t) },
-        { NJS_TOKEN_NOT_EQUAL, njs_vmcode_not_equal,
-          sizeof(njs_vmcode_3addr_t) },
-        { NJS_TOKEN_STRICT_EQUAL, njs_vmcode_strict_equal,
-          sizeof(njs_vmcode_3addr_t) },
-        { NJS_TOKEN_STRICT_NOT_EQUAL, njs_vmcode_strict_not_equal,
-          sizeof(njs_vmcode_3addr_t) },
-    }
-};
+#define njs_parser_binary_precedence(node)                                    \
+    njs_parser_binary_operations[(node)->token - NJS_PARSER_FIRST_BINARY]     \
+        .precedence
 
 
-static const njs_parser_expression_t
-    njs_parser_bitwise_and_expression =
+nxt_inline nxt_bool_t
+njs_parser_expression_operator(njs_token_t token)
 {
-    njs_parser_binary_expression,
-    &njs_parser_equality_expression,
-    1, {
-        { NJS_TOKEN_BITWISE_AND, njs_vmcode_bitwise_and,
-          sizeof(njs_vmcode_3addr_t) },
-    }
-};
+    return (token >= NJS_TOKEN_FIRST_OPERATOR
+            && token <= NJS_TOKEN_LAST_OPERATOR);
+}
 
 
-static const njs_parser_expression_t
-    njs_parser_bitwise_xor_expression =
+njs_token_t
+njs_parser_expression(njs_vm_t *vm, njs_parser_t *parser, njs_token_t token)
 {
-    njs_parser_binary_expression,
-    &njs_parser_bitwise_and_expression,
-    1, {
-        { NJS_TOKEN_BITWISE_XOR, njs_vmcode_bitwise_xor,
-          sizeof(njs_vmcode_3addr_t) },
-    }
-};
-
+    njs_parser_node_t  *node;
 
-static const njs_parser_expression_t
-    njs_parser_bitwise_or_expression =
-{
-    njs_parser_binary_expression,
-    &njs_parser_bitwise_xor_expression,
-    1, {
-        { NJS_TOKEN_BITWISE_OR, njs_vmcode_bitwise_or,
-          sizeof(njs_vmcode_3addr_t) },
+    token = njs_parser_assignment_expression(vm, parser, token);
+    if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
+        return token;
     }
-};
 
+    for ( ;; ) {
+        if (token != NJS_TOKEN_COMMA) {
 
-static const njs_parser_expression_t
-    njs_parser_logical_and_expression =
-{
-    njs_parser_binary_expression,
-    &njs_parser_bitwise_or_expression,
-    1, {
-        { NJS_TOKEN_LOGICAL_AND, njs_vmcode_test_if_false,
-          sizeof(njs_vmcode_test_jump_t) + sizeof(njs_vmcode_move_t) },
-    }
-};
+            if (token == NJS_TOKEN_LINE_END) {
 
+                token = njs_lexer_token(parser->lexer);
+                if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
+                    return token;
+                }
 
-static const njs_parser_expression_t
-    njs_parser_logical_or_expression =
-{
-    njs_parser_binary_expression,
-    &njs_parser_logical_and_expression,
-    1, {
-        { NJS_TOKEN_LOGICAL_OR, njs_vmcode_test_if_true,
-          sizeof(njs_vmcode_test_jump_t) + sizeof(njs_vmcode_move_t) },
-    }
-};
+                if (njs_parser_expression_operator(token)) {
+                    continue;
+                }
+            }
 
+            return token;
+        }
 
-static const njs_parser_expression_t
-    njs_parser_comma_expression =
-{
-    njs_parser_any_expression,
-    NULL,
-    1, {
-        { NJS_TOKEN_COMMA, NULL, 0 },
-    }
-};
+        node = njs_parser_node_alloc(vm);
+        if (nxt_slow_path(node == NULL)) {
+            return NJS_TOKEN_ERROR;
+        }
 
+        node->token = token;
+        node->scope = parser->scope;
+        node->left = parser->node;
+        node->left->dest = node;
 
-njs_token_t
-njs_parser_expression(njs_vm_t *vm, njs_parser_t *parser, njs_token_t token)
-{
-    return njs_parser_binary_expression(vm, parser,
-                                        &njs_parser_comma_expression, token);
-}
+        token = njs_parser_token(parser);
+        if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
+            return token;
+        }
 
+        token = njs_parser_assignment_expression(vm, parser, token);
+        if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
+            return token;
+        }
 
-nxt_inline nxt_bool_t
-njs_parser_expression_operator(njs_token_t token)
-{
-    return (token >= NJS_TOKEN_FIRST_OPERATOR
-            && token <= NJS_TOKEN_LAST_OPERATOR);
+        node->right = parser->node;
+        node->right->dest = node;
+        parser->node = node;
+    }
 }
 
 
@@ -308,14 +266,6 @@ njs_parser_var_expression(njs_vm_t *vm, njs_parser_t *parser, njs_token_t token)
 }
 
 
-static njs_token_t
-njs_parser_any_expression(njs_vm_t *vm, njs_parser_t *parser,
-    const njs_parser_expression_t *expr, njs_token_t token)
-{
-    return njs_parser_assignment_expression(vm, parser, token);
-}
-
-
 njs_token_t
 njs_parser_assignment_expression(njs_vm_t *vm, njs_parser_t *parser,
     njs_token_t token)
@@ -482,9 +432,7 @@ njs_parser_conditional_expression(njs_vm_t *vm, njs_parser_t *parser,
 {
     njs_parser_node_t  *node, *cond;
 
-    token = njs_parser_binary_expression(vm, parser,
-                                         &njs_parser_logical_or_expression,
-                                         token);
+    token = njs_parser_binary_expression(vm, parser, token);
     if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
         return token;
     }
@@ -550,48 +498,75 @@ njs_parser_conditional_expression(njs_vm_t *vm, njs_parser_t *parser,
 }
 
 
+/*
+ * The binary expression parser keeps operators waiting for their right
+ * operands in a stack instead of recursion over all precedence levels.
+ * An operator is reduced when a following operator has the same or
+ * lower precedence, so all binary operators are left-associative and
+ * the stack holds operators of strictly increasing precedences only.
+ */
+
 static njs_token_t
 njs_parser_binary_expression(njs_vm_t *vm, njs_parser_t *parser,
-    const njs_parser_expression_t *expr, njs_token_t token)
+    njs_token_t token)
 {
-    nxt_int_t                     n;
+    nxt_uint_t                    n;
     njs_parser_node_t             *node;
     const njs_parser_operation_t  *op;
+    njs_parser_node_t             *stack[NJS_PARSER_BINARY_PRECEDENCES];
 
-    token = expr->next(vm, parser, expr->expression, token);
+    n = 0;
+
+    token = njs_parser_exponential_expression(vm, parser, token);
     if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
         return token;
     }
 
     for ( ;; ) {
-        n = expr->count;
-        op = expr->op;
+        op = NULL;
+
+        if (token >= NJS_PARSER_FIRST_BINARY
+            && token <= NJS_PARSER_LAST_BINARY)
+        {
+            op = &njs_parser_binary_operations[token - NJS_PARSER_FIRST_BINARY];
 
-        do {
-            if (op->token == token) {
-                goto found;
+            if (op->token != token) {
+                op = NULL;
             }
+        }
 
-            op++;
-            n--;
+        if (op == NULL) {
 
-        } while (n != 0);
+            if (token == NJS_TOKEN_LINE_END) {
 
-        if (token == NJS_TOKEN_LINE_END) {
+                do {
+                    token = njs_lexer_token(parser->lexer);
+                    if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
+                        return token;
+                    }
 
-            token = njs_lexer_token(parser->lexer);
-            if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
-                return token;
-            }
+                } while (token == NJS_TOKEN_LINE_END);
 
-            if (njs_parser_expression_operator(token)) {
-                continue;
+                if (njs_parser_expression_operator(token)) {
+                    continue;
+                }
             }
+
+            break;
         }
 
-        return token;
+        while (n != 0) {
+            node = stack[n - 1];
+
+            if (njs_parser_binary_precedence(node) < op->precedence) {
+                break;
+            }
 
-    found:
+            node->right = parser->node;
+            node->right->dest = node;
+            parser->node = node;
+            n--;
+        }
 
         node = njs_parser_node_alloc(vm);
         if (nxt_slow_path(node == NULL)) {
@@ -606,30 +581,38 @@ njs_parser_binary_expression(njs_vm_t *vm, njs_parser_t *parser,
 
         parser->code_size += op->size;
 
+        stack[n++] = node;
+
         token = njs_parser_token(parser);
         if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
             return token;
         }
 
-        token = expr->next(vm, parser, expr->expression, token);
+        token = njs_parser_exponential_expression(vm, parser, token);
         if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
             return token;
         }
+    }
+
+    while (n != 0) {
+        node = stack[--n];
 
         node->right = parser->node;
         node->right->dest = node;
         parser->node = node;
     }
+
+    return token;
 }
 
 
 static njs_token_t
 njs_parser_exponential_expression(njs_vm_t *vm, njs_parser_t *parser,
-    const njs_parser_expression_t *expr, njs_token_t token)
+    njs_token_t token)
 {
     njs_parser_node_t  *node;
 
-    token = njs_parser_unary_expression(vm, parser, NULL, token);
+    token = njs_parser_unary_expression(vm, parser, token);
     if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
         return token;
     }
@@ -655,7 +638,7 @@ njs_parser_exponential_expression(njs_vm_t *vm, njs_parser_t *parser,
                 return token;
             }
 
-            token = njs_parser_exponential_expression(vm, parser, NULL, token);
+            token = njs_parser_exponential_expression(vm, parser, token);
             if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
                 return token;
             }
@@ -684,7 +667,7 @@ njs_parser_exponential_expression(njs_vm_t *vm, njs_parser_t *parser,
 
 static njs_token_t
 njs_parser_unary_expression(njs_vm_t *vm, njs_parser_t *parser,
-    const njs_parser_expression_t *expr, njs_token_t token)
+    njs_token_t token)
 {
     double                  num;
     njs_token_t             next;
@@ -732,7 +715,7 @@ njs_parser_unary_expression(njs_vm_t *vm, njs_parser_t *parser,
         return next;
     }
 
-    next = njs_parser_unary_expression(vm, parser, NULL, next);
+    next = njs_parser_unary_expression(vm, parser, next);
     if (nxt_slow_path(next <= NJS_TOKEN_ILLEGAL)) {
         return next;
     }
@@ -525,13 +525,8 @@ next:
 
     switch (cmpl->phase) {
     case NJS_COMPLETION_VAR:
-        if (cmpl->vm->parser == NULL) {
-            njs_next_phase(cmpl);
-        }
-
         for ( ;; ) {
-            var = nxt_lvlhsh_each(&cmpl->vm->parser->scope->variables,
-                                  &cmpl->lhe);
+            var = nxt_lvlhsh_each(&cmpl->vm->variables_hash, &cmpl->lhe);
 
             if (var == NULL) {
                 break;
@@ -70,6 +70,12 @@ static njs_ret_t njs_string_bytes_from_array(njs_vm_t *vm,
     const njs_value_t *value);
 static njs_ret_t njs_string_bytes_from_string(njs_vm_t *vm,
     const njs_value_t *args, nxt_uint_t nargs);
+static const u_char *njs_string_search(njs_vm_t *vm, const u_char *p,
+    const u_char *end, const u_char *ss, size_t size, nxt_bool_t utf8);
+static nxt_twoway_t *njs_string_twoway(njs_vm_t *vm, const u_char *ss,
+    size_t size);
+static const u_char *njs_string_rsearch(const u_char *start, const u_char *end,
+    const u_char *ss, size_t size, nxt_bool_t utf8);
 static njs_ret_t njs_string_starts_or_ends_with(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, nxt_bool_t starts);
 static njs_ret_t njs_string_prototype_pad(njs_vm_t *vm, njs_value_t *args,
@@ -135,6 +141,13 @@ njs_string_create(njs_vm_t *vm, njs_value_t *value, u_char *start,
             size--;
         }
 
+    } else if (size != length && length > NJS_STRING_MAP_STRIDE) {
+        /*
+         * The UTF-8 offset map is stored after the string,
+         * so the string cannot refer to the bytes in place.
+         */
+        return njs_string_new(vm, value, start, size, length);
+
     } else {
         /*
          * Setting UTF-8 length is not required here, it just allows
@@ -156,6 +169,7 @@ njs_string_create(njs_vm_t *vm, njs_value_t *value, u_char *start,
         string->start = start;
         string->length = length;
         string->retain = 1;
+        string->hash = njs_string_hash_init(vm);
     }
 
     return NXT_OK;
@@ -223,6 +237,7 @@ njs_string_alloc(njs_vm_t *vm, njs_value_t *value, uint32_t size,
         string->start = (u_char *) string + sizeof(njs_string_t);
         string->length = length;
         string->retain = 1;
+        string->hash = njs_string_hash_init(vm);
 
         if (map_offset != 0) {
             map = (uint32_t *) (string->start + map_offset);
@@ -238,6 +253,107 @@ njs_string_alloc(njs_vm_t *vm, njs_value_t *value, uint32_t size,
 }
 
 
+/*
+ * njs_string_append() creates a string of the given total size and length
+ * which starts with the src string and returns a pointer to the place for
+ * the rest size - src size bytes.
+ */
+
+u_char *
+njs_string_append(njs_vm_t *vm, njs_value_t *value, njs_value_t *src,
+    uint32_t size, uint32_t length)
+{
+    u_char               *p;
+    size_t               spare;
+    njs_string_t         *string;
+    njs_string_prop_t    prefix;
+    njs_string_buffer_t  *buffer;
+
+    (void) njs_string_prop(&prefix, src);
+
+    if (size < NJS_STRING_BUFFER_MIN) {
+        p = njs_string_alloc(vm, value, size, length);
+        if (nxt_slow_path(p == NULL)) {
+            return NULL;
+        }
+
+        memcpy(p, prefix.start, prefix.size);
+
+        return p + prefix.size;
+    }
+
+    /* A one-off concatenation result. */
+    spare = size / 4;
+
+    if (prefix.buffer) {
+        buffer = njs_string_buffer(prefix.start);
+
+        if (buffer->end == prefix.start + prefix.size
+            && (size_t) (buffer->last - buffer->end) >= size - prefix.size
+            && buffer->pool == vm->mem_cache_pool)
+        {
+            string = nxt_mem_cache_alloc(vm->mem_cache_pool,
+                                         sizeof(njs_string_t));
+            if (nxt_slow_path(string == NULL)) {
+                goto memory_error;
+            }
+
+            string->start = prefix.start;
+            string->length = length;
+            string->retain = 1;
+            string->hash = njs_string_hash_init(vm);
+
+            p = buffer->end;
+            buffer->end = prefix.start + size;
+
+            goto done;
+        }
+
+        /* The string is appended to again, the spare space doubles it. */
+        spare = size;
+    }
+
+    string = nxt_mem_cache_alloc(vm->mem_cache_pool,
+                                 sizeof(njs_string_t)
+                                 + sizeof(njs_string_buffer_t) + size + spare);
+    if (nxt_slow_path(string == NULL)) {
+        goto memory_error;
+    }
+
+    buffer = (njs_string_buffer_t *) ((u_char *) string + sizeof(njs_string_t));
+
+    string->start = (u_char *) buffer + sizeof(njs_string_buffer_t);
+    string->length = length;
+    string->retain = 1;
+    string->hash = njs_string_hash_init(vm);
+
+    buffer->end = string->start + size;
+    buffer->last = buffer->end + spare;
+    buffer->pool = vm->mem_cache_pool;
+
+    p = memcpy(string->start, prefix.start, prefix.size);
+    p += prefix.size;
+
+done:
+
+    value->type = NJS_STRING;
+    njs_string_truth(value, size);
+    value->short_string.size = NJS_STRING_LONG;
+    value->short_string.length = 0;
+    value->long_string.external = NJS_STRING_BUFFER;
+    value->long_string.size = size;
+    value->long_string.data = string;
+
+    return p;
+
+memory_error:
+
+    njs_memory_error(vm);
+
+    return NULL;
+}
+
+
 void
 njs_string_truncate(njs_value_t *value, uint32_t size)
 {
@@ -263,6 +379,10 @@ njs_string_truncate(njs_value_t *value, uint32_t size)
 
     } else {
         value->long_string.size = size;
+
+        if (value->long_string.data->hash != NJS_STRING_HASH_STATIC) {
+            value->long_string.data->hash = 0;
+        }
     }
 }
 
@@ -450,6 +570,7 @@ njs_string_validate(njs_vm_t *vm, njs_string_prop_t *string, njs_value_t *value)
     if (size != NJS_STRING_LONG) {
         string->start = value->short_string.start;
         length = value->short_string.length;
+        string->buffer = 0;
 
         if (length == 0 && length != size) {
             length = nxt_utf8_length(value->short_string.start, size);
@@ -466,6 +587,7 @@ njs_string_validate(njs_vm_t *vm, njs_string_prop_t *string, njs_value_t *value)
         string->start = value->long_string.data->start;
         size = value->long_string.size;
         length = value->long_string.data->length;
+        string->buffer = (value->long_string.external == NJS_STRING_BUFFER);
 
         if (length == 0 && length != size) {
             length = nxt_utf8_length(string->start, size);
@@ -476,7 +598,7 @@ njs_string_validate(njs_vm_t *vm, njs_string_prop_t *string, njs_value_t *value)
                     return length;
                 }
 
-                if (length > NJS_STRING_MAP_STRIDE) {
+                if (length > NJS_STRING_MAP_STRIDE && !string->buffer) {
                     /*
                      * Reallocate the long string with offset map
                      * after the string.
@@ -521,11 +643,13 @@ njs_string_prop(njs_string_prop_t *string, njs_value_t *value)
     if (size != NJS_STRING_LONG) {
         string->start = value->short_string.start;
         length = value->short_string.length;
+        string->buffer = 0;
 
     } else {
         string->start = value->long_string.data->start;
         size = value->long_string.size;
         length = value->long_string.data->length;
+        string->buffer = (value->long_string.external == NJS_STRING_BUFFER);
     }
 
     string->size = size;
@@ -907,16 +1031,8 @@ njs_string_prototype_from_utf8(njs_vm_t *vm, njs_value_t *args,
     length = nxt_utf8_length(string.start, slice.length);
 
     if (length >= 0) {
-
-        if (length < NJS_STRING_MAP_STRIDE || (size_t) length == slice.length) {
-            /* ASCII or short UTF-8 string. */
-            return njs_string_create(vm, &vm->retval, string.start,
-                                     slice.length, length);
-        }
-
-        /* Long UTF-8 string. */
-        return njs_string_new(vm, &vm->retval, string.start, slice.length,
-                              length);
+        return njs_string_create(vm, &vm->retval, string.start, slice.length,
+                                 length);
     }
 
     vm->retval = njs_value_null;
@@ -1033,7 +1149,7 @@ njs_string_prototype_to_bytes(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             /* UTF-8 string. */
             end = string.start + string.size;
 
-            s = njs_string_offset(string.start, end, slice.start);
+            s = njs_string_offset(vm, &string, slice.start);
 
             length = slice.length;
 
@@ -1310,7 +1426,7 @@ njs_string_slice(njs_vm_t *vm, njs_value_t *dst,
     } else {
         /* UTF-8 string. */
         end = start + string->size;
-        start = njs_string_offset(start, end, slice->start);
+        start = njs_string_offset(vm, string, slice->start);
 
         /* Evaluate size of the slice in bytes and ajdust length. */
         p = start;
@@ -1326,7 +1442,12 @@ njs_string_slice(njs_vm_t *vm, njs_value_t *dst,
     }
 
     if (nxt_fast_path(size != 0)) {
-        return njs_string_new(vm, dst, start, size, length);
+        /*
+         * Strings are not freed until the VM is destroyed, so a long
+         * slice refers to the bytes of the original string.  Slices
+         * up to NJS_STRING_SHORT bytes are copied into the value.
+         */
+        return njs_string_create(vm, dst, (u_char *) start, size, length);
     }
 
     *dst = njs_string_empty;
@@ -1365,7 +1486,7 @@ njs_string_prototype_char_code_at(njs_vm_t *vm, njs_value_t *args,
     } else {
         /* UTF-8 string. */
         end = string.start + string.size;
-        start = njs_string_offset(string.start, end, index);
+        start = njs_string_offset(vm, &string, index);
         code = nxt_utf8_decode(&start, end);
     }
 
@@ -1698,6 +1819,94 @@ range_error:
 }
 
 
+/*
+ * njs_string_search() and njs_string_rsearch() look for the first and
+ * the last occurrences of a string.  In a UTF-8 string an occurrence
+ * should start at a character boundary, it matters only if the search
+ * string is a byte string.
+ */
+
+static const u_char *
+njs_string_search(njs_vm_t *vm, const u_char *p, const u_char *end,
+    const u_char *ss, size_t size, nxt_bool_t utf8)
+{
+    nxt_twoway_t  *tw;
+
+    tw = NULL;
+
+    if (size >= NJS_STRING_SEARCH_LONG
+        && (size_t) (end - p) >= NJS_STRING_SEARCH_TEXT)
+    {
+        /* The search falls back to nxt_memstr() if allocation fails. */
+        tw = njs_string_twoway(vm, ss, size);
+    }
+
+    for ( ;; ) {
+        if (tw != NULL) {
+            p = nxt_twoway_search(tw, p, end);
+
+        } else {
+            p = nxt_memstr(p, end, ss, size);
+        }
+
+        if (p == NULL || !utf8 || size == 0 || (*p & 0xc0) != 0x80) {
+            return p;
+        }
+
+        p++;
+    }
+}
+
+
+static nxt_twoway_t *
+njs_string_twoway(njs_vm_t *vm, const u_char *ss, size_t size)
+{
+    u_char        *start;
+    nxt_twoway_t  *tw;
+
+    tw = vm->twoway;
+
+    if (tw != NULL) {
+        if (tw->length == size && memcmp(tw->start, ss, size) == 0) {
+            return tw;
+        }
+
+        nxt_mem_cache_free(vm->mem_cache_pool, tw);
+    }
+
+    tw = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(nxt_twoway_t) + size);
+
+    vm->twoway = tw;
+
+    if (nxt_fast_path(tw != NULL)) {
+        start = (u_char *) tw + sizeof(nxt_twoway_t);
+        memcpy(start, ss, size);
+
+        nxt_twoway_init(tw, start, size);
+    }
+
+    return tw;
+}
+
+
+static const u_char *
+njs_string_rsearch(const u_char *start, const u_char *end, const u_char *ss,
+    size_t size, nxt_bool_t utf8)
+{
+    const u_char  *p;
+
+    for ( ;; ) {
+        p = nxt_memrstr(start, end, ss, size);
+
+        if (p == NULL || !utf8 || size == 0 || (*p & 0xc0) != 0x80) {
+            return p;
+        }
+
+        end = p + size - 1;
+    }
+}
+
+
 static njs_ret_t
 njs_string_prototype_index_of(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
@@ -1725,31 +1934,19 @@ njs_string_prototype_index_of(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
             if (string.size == (size_t) length) {
                 /* Byte or ASCII string. */
-
-                end -= (search.size - 1);
-
-                for (p = string.start + index; p < end; p++) {
-                    if (memcmp(p, search.start, search.size) == 0) {
-                        goto done;
-                    }
-
-                    index++;
-                }
+                p = string.start + index;
 
             } else {
                 /* UTF-8 string. */
+                p = njs_string_offset(vm, &string, index);
+            }
 
-                p = njs_string_offset(string.start, end, index);
-                end -= search.size - 1;
-
-                while (p < end) {
-                    if (memcmp(p, search.start, search.size) == 0) {
-                        goto done;
-                    }
+            p = njs_string_search(vm, p, end, search.start, search.size,
+                                  string.size != (size_t) length);
 
-                    index++;
-                    p = nxt_utf8_next(p, end);
-                }
+            if (p != NULL) {
+                index = njs_string_index(&string, p - string.start);
+                goto done;
             }
 
         } else if (search.size == 0) {
@@ -1772,7 +1969,7 @@ static njs_ret_t
 njs_string_prototype_last_index_of(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
-    ssize_t            index, start, length, search_length;
+    ssize_t            index, length, search_length;
     const u_char       *p, *end;
     njs_string_prop_t  string, search;
 
@@ -1800,53 +1997,32 @@ njs_string_prototype_last_index_of(njs_vm_t *vm, njs_value_t *args,
             index = length;
         }
 
+        end = string.start + string.size;
+
         if (string.size == (size_t) length) {
             /* Byte or ASCII string. */
-
-            start = length - search.size;
-
-            if (index > start) {
-                index = start;
-            }
-
             p = string.start + index;
 
-            do {
-                if (memcmp(p, search.start, search.size) == 0) {
-                    goto done;
-                }
-
-                index--;
-                p--;
-
-            } while (p >= string.start);
-
         } else {
             /* UTF-8 string. */
+            p = njs_string_offset(vm, &string, index);
+        }
 
-            end = string.start + string.size;
-            p = njs_string_offset(string.start, end, index);
-            end -= search.size;
-
-            while (p > end) {
-                index--;
-                p = nxt_utf8_prev(p);
-            }
-
-            for ( ;; ) {
-                if (memcmp(p, search.start, search.size) == 0) {
-                    goto done;
-                }
+        /* A match starts at or before the index and may extend beyond it. */
 
-                index--;
+        if ((size_t) (end - p) > search.size) {
+            end = p + search.size;
+        }
 
-                if (p <= string.start) {
-                    break;
-                }
+        p = njs_string_rsearch(string.start, end, search.start, search.size,
+                               string.size != (size_t) length);
 
-                p = nxt_utf8_prev(p);
-            }
+        if (p != NULL) {
+            index = njs_string_index(&string, p - string.start);
+            goto done;
         }
+
+        index = -1;
     }
 
 done:
@@ -1896,17 +2072,14 @@ njs_string_prototype_includes(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
             } else {
                 /* UTF-8 string. */
-                p = njs_string_offset(string.start, end, index);
+                p = njs_string_offset(vm, &string, index);
             }
 
-            end -= search.size - 1;
+            p = njs_string_search(vm, p, end, search.start, search.size,
+                                  string.size != (size_t) length);
 
-            while (p < end) {
-                if (memcmp(p, search.start, search.size) == 0) {
-                    goto done;
-                }
-
-                p++;
+            if (p != NULL) {
+                goto done;
             }
         }
     }
@@ -1988,7 +2161,7 @@ njs_string_starts_or_ends_with(njs_vm_t *vm, njs_value_t *args,
 
         } else {
             /* UTF-8 string. */
-            p = njs_string_offset(string.start, end, index);
+            p = njs_string_offset(vm, &string, index);
         }
 
         if ((size_t) (end - p) >= search.size
@@ -2012,29 +2185,95 @@ done:
 
 /*
  * njs_string_offset() assumes that index is correct.
+ *
+ * The offset map allows to find a character of a long string in at most
+ * NJS_STRING_MAP_STRIDE - 1 steps.  Besides, the last found character is
+ * remembered, so characters accessed sequentially in either direction
+ * are found in one step.  The cursor is stored in the VM because the
+ * constant strings are shared by cloned VMs and must not be changed.
+ * UTF-8 strings with the map and strings in concatenation buffers have
+ * their own bytes and are not freed while the VM exists, so the string
+ * is identified by its start and end.  Strings in concatenation buffers
+ * have no map and are searched from the start or from the cursor.
  */
 
 nxt_noinline const u_char *
-njs_string_offset(const u_char *start, const u_char *end, size_t index)
+njs_string_offset(njs_vm_t *vm, const njs_string_prop_t *string, size_t index)
 {
-    uint32_t    *map;
-    nxt_uint_t  skip;
+    uint32_t             *map;
+    nxt_uint_t           n, skip;
+    const u_char         *p, *start, *end;
+    njs_string_cursor_t  *cursor;
 
-    if (index >= NJS_STRING_MAP_STRIDE) {
-        map = njs_string_map_start(end);
+    start = string->start;
+    end = start + string->size;
 
-        if (map[0] == 0) {
-            njs_string_offset_map_init(start, end - start);
+    skip = index % NJS_STRING_MAP_STRIDE;
+
+    if (index < NJS_STRING_MAP_STRIDE) {
+        /* The string may have no map. */
+
+        while (skip != 0) {
+            start = nxt_utf8_next(start, end);
+            skip--;
+        }
+
+        return start;
+    }
+
+    if (string->buffer) {
+        skip = index;
+    }
+
+    p = NULL;
+    cursor = &vm->cursor;
+
+    if (cursor->start == start && cursor->end == end) {
+
+        if (index >= cursor->index) {
+            if (index - cursor->index <= skip) {
+                p = cursor->position;
+                skip = index - cursor->index;
+            }
+
+        } else if (cursor->index - index < skip) {
+            p = cursor->position;
+
+            for (n = cursor->index - index; n != 0; n--) {
+                p = nxt_utf8_prev(p);
+            }
+
+            skip = 0;
         }
+    }
+
+    if (p == NULL) {
+
+        if (string->buffer) {
+            p = start;
+
+        } else {
+            map = njs_string_map_start(end);
+
+            if (map[0] == 0) {
+                njs_string_offset_map_init(start, end - start);
+            }
 
-        start += map[index / NJS_STRING_MAP_STRIDE - 1];
+            p = start + map[index / NJS_STRING_MAP_STRIDE - 1];
+        }
     }
 
-    for (skip = index % NJS_STRING_MAP_STRIDE; skip != 0; skip--) {
-        start = nxt_utf8_next(start, end);
+    while (skip != 0) {
+        p = nxt_utf8_next(p, end);
+        skip--;
     }
 
-    return start;
+    cursor->start = start;
+    cursor->end = end;
+    cursor->position = p;
+    cursor->index = index;
+
+    return p;
 }
 
 
@@ -2055,7 +2294,7 @@ njs_string_index(njs_string_prop_t *string, uint32_t offset)
     last = 0;
     index = 0;
 
-    if (string->length >= NJS_STRING_MAP_STRIDE) {
+    if (string->length >= NJS_STRING_MAP_STRIDE && !string->buffer) {
 
         end = string->start + string->size;
         map = njs_string_map_start(end);
@@ -2124,7 +2363,7 @@ static njs_ret_t
 njs_string_prototype_to_lower_case(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
-    size_t             size;
+    size_t             n, length;
     u_char             *p, *start;
     const u_char       *s, *end;
     njs_string_prop_t  string;
@@ -2138,23 +2377,42 @@ njs_string_prototype_to_lower_case(njs_vm_t *vm, njs_value_t *args,
 
     p = start;
     s = string.start;
-    size = string.size;
+    end = s + string.size;
 
-    if (string.length == 0 || string.length == size) {
+    /* ASCII characters are converted by blocks. */
+
+    if (string.length == 0 || string.length == string.size) {
         /* Byte or ASCII string. */
 
-        while (size != 0) {
-            *p++ = nxt_lower_case(*s++);
-            size--;
+        for ( ;; ) {
+            n = nxt_ascii_lower_case(p, s, end - s);
+            p += n;
+            s += n;
+
+            if (s == end) {
+                break;
+            }
+
+            /* A byte of a byte string. */
+            *p++ = *s++;
         }
 
     } else {
         /* UTF-8 string. */
-        end = s + size;
+        length = string.length;
+
+        for ( ;; ) {
+            n = nxt_ascii_lower_case(p, s, end - s);
+            p += n;
+            s += n;
+            length -= n;
+
+            if (length == 0) {
+                break;
+            }
 
-        while (size != 0) {
             p = nxt_utf8_encode(p, nxt_utf8_lower_case(&s, end));
-            size--;
+            length--;
         }
     }
 
@@ -2172,7 +2430,7 @@ static njs_ret_t
 njs_string_prototype_to_upper_case(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
-    size_t             size;
+    size_t             n, length;
     u_char             *p, *start;
     const u_char       *s, *end;
     njs_string_prop_t  string;
@@ -2186,23 +2444,42 @@ njs_string_prototype_to_upper_case(njs_vm_t *vm, njs_value_t *args,
 
     p = start;
     s = string.start;
-    size = string.size;
+    end = s + string.size;
 
-    if (string.length == 0 || string.length == size) {
+    /* ASCII characters are converted by blocks. */
+
+    if (string.length == 0 || string.length == string.size) {
         /* Byte or ASCII string. */
 
-        while (size != 0) {
-            *p++ = nxt_upper_case(*s++);
-            size--;
+        for ( ;; ) {
+            n = nxt_ascii_upper_case(p, s, end - s);
+            p += n;
+            s += n;
+
+            if (s == end) {
+                break;
+            }
+
+            /* A byte of a byte string. */
+            *p++ = *s++;
         }
 
     } else {
         /* UTF-8 string. */
-        end = s + size;
+        length = string.length;
+
+        for ( ;; ) {
+            n = nxt_ascii_upper_case(p, s, end - s);
+            p += n;
+            s += n;
+            length -= n;
+
+            if (length == 0) {
+                break;
+            }
 
-        while (size != 0) {
             p = nxt_utf8_encode(p, nxt_utf8_upper_case(&s, end));
-            size--;
+            length--;
         }
     }
 
@@ -2273,7 +2550,13 @@ njs_string_prototype_trim(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
         while (p < end) {
             prev = p;
-            u = nxt_utf8_decode(&p, end);
+
+            if (*p < 0x80) {
+                u = *p++;
+
+            } else {
+                u = nxt_utf8_decode(&p, end);
+            }
 
             switch (u) {
             case 0x0009:  /* <TAB>  */
@@ -2294,9 +2577,15 @@ njs_string_prototype_trim(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
                 prev = end;
 
                 for ( ;; ) {
-                    prev = nxt_utf8_prev(prev);
-                    p = prev;
-                    u = nxt_utf8_decode(&p, end);
+                    if (prev[-1] < 0x80) {
+                        u = *(--prev);
+                        p = prev + 1;
+
+                    } else {
+                        prev = nxt_utf8_prev(prev);
+                        p = prev;
+                        u = nxt_utf8_decode(&p, end);
+                    }
 
                     switch (u) {
                     case 0x0009:  /* <TAB>  */
@@ -2449,8 +2738,7 @@ njs_string_prototype_pad(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
             if (pad_string.size != (size_t) pad_length) {
                 /* UTF-8 string. */
-                end = pad_string.start + pad_string.size;
-                end = njs_string_offset(pad_string.start, end, trunc);
+                end = njs_string_offset(vm, &pad_string, trunc);
 
                 trunc = end - pad_string.start;
                 padding = pad_string.size * n + trunc;
@@ -2776,10 +3064,11 @@ njs_string_prototype_split(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             end = string.start + string.size;
 
             do {
-                for (p = start; p < end; p++) {
-                    if (memcmp(p, split.start, split.size) == 0) {
-                        break;
-                    }
+                p = (u_char *) njs_string_search(vm, start, end, split.start,
+                                                 split.size, 0);
+
+                if (p == NULL) {
+                    p = (u_char *) end;
                 }
 
                 next = p + split.size;
@@ -3193,55 +3482,45 @@ njs_string_replace_search(njs_vm_t *vm, njs_value_t *args,
     njs_string_replace_t *r)
 {
     int        captures[2];
-    u_char     *p, *end;
+    u_char     *p;
     size_t     size;
     njs_ret_t  ret;
     nxt_str_t  search;
 
     njs_string_get(&args[1], &search);
 
-    p = r->part[0].start;
-    end = (p + r->part[0].size) - (search.length - 1);
-
-    do {
-        if (memcmp(p, search.start, search.length) == 0) {
-
-            if (r->substitutions != NULL) {
-                captures[0] = p - r->part[0].start;
-                captures[1] = captures[0] + search.length;
-
-                ret = njs_string_replace_substitute(vm, r, captures);
-                if (nxt_slow_path(ret != NXT_OK)) {
-                    return ret;
-                }
+    p = (u_char *) njs_string_search(vm, r->part[0].start,
+                                     r->part[0].start + r->part[0].size,
+                                     search.start, search.length,
+                                     r->utf8 == NJS_STRING_UTF8);
 
-            } else {
-                r->part[2].start = p + search.length;
-                size = p - r->part[0].start;
-                r->part[2].size = r->part[0].size - size - search.length;
-                r->part[0].size = size;
-                njs_set_invalid(&r->part[2].value);
+    if (p == NULL) {
+        njs_string_copy(&vm->retval, &args[0]);
+        return NXT_OK;
+    }
 
-                if (r->function != NULL) {
-                    return njs_string_replace_search_function(vm, args, r);
-                }
-            }
+    if (r->substitutions != NULL) {
+        captures[0] = p - r->part[0].start;
+        captures[1] = captures[0] + search.length;
 
-            return njs_string_replace_join(vm, r);
+        ret = njs_string_replace_substitute(vm, r, captures);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
         }
 
-        if (r->utf8 < 2) {
-            p++;
-
-        } else {
-            p = (u_char *) nxt_utf8_next(p, end);
+    } else {
+        r->part[2].start = p + search.length;
+        size = p - r->part[0].start;
+        r->part[2].size = r->part[0].size - size - search.length;
+        r->part[0].size = size;
+        njs_set_invalid(&r->part[2].value);
+
+        if (r->function != NULL) {
+            return njs_string_replace_search_function(vm, args, r);
         }
+    }
 
-    } while (p < end);
-
-    njs_string_copy(&vm->retval, &args[0]);
-
-    return NXT_OK;
+    return njs_string_replace_join(vm, r);
 }
 
 
@@ -4350,7 +4629,7 @@ njs_index_t
 njs_value_index(njs_vm_t *vm, njs_parser_t *parser, const njs_value_t *src)
 {
     u_char              *start;
-    uint32_t            value_size, size, length;
+    uint32_t            value_size, size, length, *map;
     nxt_int_t           ret;
     njs_value_t         *value;
     njs_string_t        *string;
@@ -4409,8 +4688,27 @@ njs_value_index(njs_vm_t *vm, njs_parser_t *parser, const njs_value_t *src)
             string->start = (u_char *) string + sizeof(njs_string_t);
             string->length = src->long_string.data->length;
             string->retain = 0xffff;
+            string->hash = nxt_max(lhq.key_hash, NJS_STRING_HASH_STATIC);
 
             memcpy(string->start, start, size);
+
+            /*
+             * Constants are shared by cloned VMs which may run in
+             * different threads, so the offset map of a constant
+             * must be initialized here rather than lazily on demand.
+             */
+
+            size = value->long_string.size;
+
+            if (size != string->length
+                && string->length > NJS_STRING_MAP_STRIDE)
+            {
+                map = njs_string_map_start(string->start + size);
+
+                if (map[0] == 0) {
+                    njs_string_offset_map_init(string->start, size);
+                }
+            }
         }
 
         lhq.replace = 0;
@@ -4440,6 +4738,113 @@ njs_value_index(njs_vm_t *vm, njs_parser_t *parser, const njs_value_t *src)
 }
 
 
+static nxt_int_t
+njs_atoms_hash_test(nxt_lvlhsh_query_t *lhq, void *data)
+{
+    njs_value_t  *value;
+
+    value = data;
+
+    if (njs_is_string(value)
+        && value->short_string.size == NJS_STRING_LONG
+        && value->long_string.size == lhq->key.length
+        && memcmp(value->long_string.data->start, lhq->key.start,
+                  lhq->key.length)
+           == 0)
+    {
+        return NXT_OK;
+    }
+
+    return NXT_DECLINED;
+}
+
+
+static const nxt_lvlhsh_proto_t  njs_atoms_hash_proto
+    nxt_aligned(64) =
+{
+    NXT_LVLHSH_DEFAULT,
+    0,
+    njs_atoms_hash_test,
+    njs_lvlhsh_alloc,
+    njs_lvlhsh_free,
+};
+
+
+/*
+ * Long property names created at run time, e.g. keys of objects parsed by
+ * JSON.parse(), are interned.  A name equal to a string constant or to
+ * a name interned before refers to the same string, so the name of many
+ * objects is allocated and hashed once and lookups of the name mostly
+ * succeed by pointer comparison in njs_object_hash_test().  The constants
+ * are shared read-only by cloned VMs, the interned names are kept in the
+ * VM atoms table.  Short names are stored in values and are not interned.
+ * The table lives as long as the VM, so only names of up to
+ * NJS_STRING_ATOM_SIZE bytes are interned and no more than
+ * NJS_STRING_ATOMS_MAX of them, other names are created as usual.
+ */
+
+njs_ret_t
+njs_string_atom(njs_vm_t *vm, njs_value_t *value, u_char *start,
+    uint32_t size, uint32_t length)
+{
+    njs_ret_t           ret;
+    njs_value_t         *atom;
+    nxt_lvlhsh_query_t  lhq;
+
+    if (size <= NJS_STRING_SHORT || size > NJS_STRING_ATOM_SIZE) {
+        return njs_string_create(vm, value, start, size, length);
+    }
+
+    lhq.key_hash = nxt_djb_hash(start, size);
+    lhq.key.length = size;
+    lhq.key.start = start;
+    lhq.proto = &njs_atoms_hash_proto;
+
+    if (nxt_lvlhsh_find(&vm->shared->values_hash, &lhq) == NXT_OK
+        || nxt_lvlhsh_find(&vm->atoms, &lhq) == NXT_OK)
+    {
+        *value = *(njs_value_t *) lhq.value;
+        return NXT_OK;
+    }
+
+    ret = njs_string_create(vm, value, start, size, length);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    if (lhq.key_hash > NJS_STRING_HASH_STATIC) {
+        value->long_string.data->hash = lhq.key_hash;
+    }
+
+    if (vm->natoms == NJS_STRING_ATOMS_MAX) {
+        return NXT_OK;
+    }
+
+    atom = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t),
+                               sizeof(njs_value_t));
+    if (nxt_slow_path(atom == NULL)) {
+        njs_memory_error(vm);
+        return NXT_ERROR;
+    }
+
+    *atom = *value;
+
+    lhq.replace = 0;
+    lhq.value = atom;
+    lhq.pool = vm->mem_cache_pool;
+
+    ret = nxt_lvlhsh_insert(&vm->atoms, &lhq);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        njs_internal_error(vm, "lvlhsh insert failed");
+        return NXT_ERROR;
+    }
+
+    vm->natoms++;
+
+    return NXT_OK;
+}
+
+
 const njs_object_init_t  njs_to_string_function_init = {
     nxt_string("toString"),
     NULL,
@@ -35,6 +35,15 @@
  */
 #define NJS_STRING_MAP_STRIDE  32
 
+/*
+ * Strings of NJS_STRING_SEARCH_LONG bytes or longer are searched in texts
+ * of NJS_STRING_SEARCH_TEXT bytes or longer with the two-way search.  The
+ * last prepared search is kept in the VM and is reused while the same
+ * string is searched.
+ */
+#define NJS_STRING_SEARCH_LONG  32
+#define NJS_STRING_SEARCH_TEXT  1024
+
 #define njs_string_map_offset(size)  nxt_align_size((size), sizeof(uint32_t))
 
 #define njs_string_map_start(p)                                               \
@@ -63,7 +72,8 @@
  * 1) if string length is zero hence string is a byte string;
  * 2) if string size and length are equal so the string contains only
  *    ASCII characters and map is not required;
- * 3) if string length is less than NJS_STRING_MAP_STRIDE.
+ * 3) if string length is less than NJS_STRING_MAP_STRIDE;
+ * 4) if string is in a concatenation buffer, see njs_string_buffer_t.
  *
  * The current implementation does not support Unicode surrogate pairs.
  * It can be implemented later if it will be required using the following
@@ -75,13 +85,73 @@ struct njs_string_s {
     u_char    *start;
     uint32_t  length;   /* Length in UTF-8 characters. */
     uint32_t  retain;   /* Link counter. */
+    uint32_t  hash;     /* Property name hash, see njs_string_hash(). */
 };
 
 
+/*
+ * The hash of a long string used as a property name is cached in the
+ * string on first use.  Zero means that the hash is not evaluated yet.
+ * Strings shared by cloned VMs must not be changed: hashes of constants
+ * and of strings of object and array templates are set by
+ * njs_value_index(), while static njs_long_string() values and other
+ * strings allocated during compilation are marked with
+ * NJS_STRING_HASH_STATIC, so their hashes are not cached.  Thus hashes
+ * are cached only in strings allocated by the VM at run time.  A hash
+ * equal to one of these values is not cached either.
+ */
+
+#define NJS_STRING_HASH_STATIC  1
+
+#define njs_string_hash_init(vm)                                              \
+    (((vm)->parser != NULL) ? NJS_STRING_HASH_STATIC : 0)
+
+
+/*
+ * A long string produced by concatenation is allocated in a buffer with
+ * spare space after the string.  The buffer header precedes the string
+ * start and the long_string.external field of such strings is set to
+ * NJS_STRING_BUFFER.  If a concatenation starts with a string which ends
+ * where the used part of the buffer ends, the second operand is appended
+ * in place and the result shares the buffer, so repeated "s += chunk"
+ * copies each chunk once instead of the whole string each time.  Strings
+ * in a buffer have no UTF-8 offset map because appended bytes would
+ * overwrite it, characters are found from the start of the string or
+ * from the cursor of njs_string_offset().
+ *
+ * The first buffer of a result gets a quarter of the result size as spare
+ * space, so a one-off concatenation does not double the memory it uses.  A result
+ * which outgrows the spare space of its buffer is moved to a buffer with
+ * spare space of its size, thus repeated concatenation copies each byte
+ * a constant number of times on average.
+ */
+
+#define NJS_STRING_BUFFER      1
+
+/* The minimum size of concatenation result allocated in a buffer. */
+#define NJS_STRING_BUFFER_MIN  256
+
 typedef struct {
-    size_t    size;
-    size_t    length;
-    u_char    *start;
+    u_char                *end;
+    u_char                *last;
+    nxt_mem_cache_pool_t  *pool;
+} njs_string_buffer_t;
+
+#define njs_string_buffer(start)                                              \
+    ((njs_string_buffer_t *) ((start) - sizeof(njs_string_buffer_t)))
+
+
+/* Limits of property names interned by njs_string_atom(). */
+#define NJS_STRING_ATOM_SIZE  64
+#define NJS_STRING_ATOMS_MAX  4096
+
+
+typedef struct {
+    size_t      size;
+    size_t      length;
+    u_char      *start;
+    /* The string is in a concatenation buffer and has no offset map. */
+    nxt_bool_t  buffer;
 } njs_string_prop_t;
 
 
@@ -121,8 +191,36 @@ njs_string_length(njs_utf8_t utf8, u_char *start, size_t size)
 }
 
 
+nxt_inline uint32_t
+njs_string_hash(const njs_value_t *value, const nxt_str_t *key)
+{
+    uint32_t      hash;
+    njs_string_t  *string;
+
+    if (value->short_string.size != NJS_STRING_LONG) {
+        return nxt_djb_hash(key->start, key->length);
+    }
+
+    string = value->long_string.data;
+
+    if (string->hash > NJS_STRING_HASH_STATIC) {
+        return string->hash;
+    }
+
+    hash = nxt_djb_hash(key->start, key->length);
+
+    if (string->hash == 0) {
+        string->hash = hash;
+    }
+
+    return hash;
+}
+
+
 njs_ret_t njs_string_new(njs_vm_t *vm, njs_value_t *value, const u_char *start,
     uint32_t size, uint32_t length);
+u_char *njs_string_append(njs_vm_t *vm, njs_value_t *value, njs_value_t *src,
+    uint32_t size, uint32_t length);
 njs_ret_t njs_string_hex(njs_vm_t *vm, njs_value_t *value,
     const nxt_str_t *src);
 njs_ret_t njs_string_base64(njs_vm_t *vm, njs_value_t *value,
@@ -147,8 +245,8 @@ nxt_bool_t njs_string_eq(const njs_value_t *val1, const njs_value_t *val2);
 nxt_int_t njs_string_cmp(const njs_value_t *val1, const njs_value_t *val2);
 njs_ret_t njs_string_slice(njs_vm_t *vm, njs_value_t *dst,
     const njs_string_prop_t *string, const njs_slice_prop_t *slice);
-const u_char *njs_string_offset(const u_char *start, const u_char *end,
-    size_t index);
+const u_char *njs_string_offset(njs_vm_t *vm,
+    const njs_string_prop_t *string, size_t index);
 nxt_noinline uint32_t njs_string_index(njs_string_prop_t *string,
     uint32_t offset);
 void njs_string_offset_map_init(const u_char *start, size_t size);
@@ -168,6 +266,8 @@ njs_ret_t njs_string_decode_uri_component(njs_vm_t *vm, njs_value_t *args,
 
 njs_index_t njs_value_index(njs_vm_t *vm, njs_parser_t *parser,
     const njs_value_t *src);
+njs_ret_t njs_string_atom(njs_vm_t *vm, njs_value_t *value, u_char *start,
+    uint32_t size, uint32_t length);
 
 extern const njs_object_init_t  njs_string_constructor_init;
 extern const njs_object_init_t  njs_string_prototype_init;
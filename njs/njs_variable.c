@@ -65,7 +65,9 @@ njs_builtin_add(njs_vm_t *vm, njs_parser_t *parser)
         scope = scope->parent;
     }
 
-    if (nxt_lvlhsh_find(&scope->variables, &lhq) == NXT_OK) {
+    if (nxt_lvlhsh_find(&scope->variables, &lhq) == NXT_OK
+        || nxt_lvlhsh_find(&vm->variables_hash, &lhq) == NXT_OK)
+    {
         var = lhq.value;
 
         return var;
@@ -181,27 +183,36 @@ njs_variable_reference(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node, njs_variable_reference_t reference)
 {
     njs_ret_t           ret;
+    nxt_str_t           *name;
     nxt_lvlhsh_query_t  lhq;
 
-    ret = njs_name_copy(vm, &node->u.variable_name, &parser->lexer->text);
+    name = &parser->lexer->text;
 
-    if (nxt_fast_path(ret == NXT_OK)) {
-        node->variable_name_hash = parser->lexer->key_hash;
-        node->scope = parser->scope;
-        node->reference = reference;
+    node->u.variable_name.start = nxt_mem_cache_alloc(vm->compile_pool,
+                                                      name->length);
+    if (nxt_slow_path(node->u.variable_name.start == NULL)) {
+        njs_memory_error(vm);
+        return NXT_ERROR;
+    }
 
-        lhq.key_hash = node->variable_name_hash;
-        lhq.key = node->u.variable_name;
-        lhq.proto = &njs_reference_hash_proto;
-        lhq.replace = 0;
-        lhq.value = node;
-        lhq.pool = vm->mem_cache_pool;
+    memcpy(node->u.variable_name.start, name->start, name->length);
+    node->u.variable_name.length = name->length;
 
-        ret = nxt_lvlhsh_insert(&parser->scope->references, &lhq);
+    node->variable_name_hash = parser->lexer->key_hash;
+    node->scope = parser->scope;
+    node->reference = reference;
 
-        if (nxt_slow_path(ret != NXT_ERROR)) {
-            ret = NXT_OK;
-        }
+    lhq.key_hash = node->variable_name_hash;
+    lhq.key = node->u.variable_name;
+    lhq.proto = &njs_reference_hash_proto;
+    lhq.replace = 0;
+    lhq.value = node;
+    lhq.pool = vm->compile_pool;
+
+    ret = nxt_lvlhsh_insert(&parser->scope->references, &lhq);
+
+    if (nxt_slow_path(ret != NXT_ERROR)) {
+        ret = NXT_OK;
     }
 
     return ret;
@@ -300,6 +311,46 @@ njs_variables_scope_reference(njs_vm_t *vm, njs_parser_scope_t *scope)
 }
 
 
+/*
+ * The global variables of a compilation in accumulative mode are added
+ * to the variables of the previous compilations only after successful
+ * compilation, so a line with an error does not leave its declarations.
+ */
+
+njs_ret_t
+njs_variables_global_merge(njs_vm_t *vm, njs_parser_scope_t *scope)
+{
+    nxt_int_t           ret;
+    njs_variable_t      *var;
+    nxt_lvlhsh_each_t   lhe;
+    nxt_lvlhsh_query_t  lhq;
+
+    nxt_lvlhsh_each_init(&lhe, &njs_variables_hash_proto);
+
+    lhq.proto = &njs_variables_hash_proto;
+    lhq.replace = 1;
+    lhq.pool = vm->mem_cache_pool;
+
+    for ( ;; ) {
+        var = nxt_lvlhsh_each(&scope->variables, &lhe);
+
+        if (var == NULL) {
+            return NXT_OK;
+        }
+
+        lhq.value = var;
+        lhq.key = var->name;
+        lhq.key_hash = nxt_djb_hash(var->name.start, var->name.length);
+
+        ret = nxt_lvlhsh_insert(&vm->variables_hash, &lhq);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            njs_memory_error(vm);
+            return NXT_ERROR;
+        }
+    }
+}
+
+
 njs_index_t
 njs_variable_typeof(njs_vm_t *vm, njs_parser_node_t *node)
 {
@@ -409,7 +460,7 @@ njs_variable_get(njs_vm_t *vm, njs_parser_node_t *node)
 
         if (values == NULL) {
             values = nxt_array_create(4, sizeof(njs_value_t),
-                                      &njs_array_mem_proto, vm->mem_cache_pool);
+                                      &njs_array_mem_proto, vm->compile_pool);
             if (nxt_slow_path(values == NULL)) {
                 return NULL;
             }
@@ -417,7 +468,7 @@ njs_variable_get(njs_vm_t *vm, njs_parser_node_t *node)
             vs.scope->values[scope_index] = values;
         }
 
-        value = nxt_array_add(values, &njs_array_mem_proto, vm->mem_cache_pool);
+        value = nxt_array_add(values, &njs_array_mem_proto, vm->compile_pool);
         if (nxt_slow_path(value == NULL)) {
             return NULL;
         }
@@ -488,6 +539,13 @@ njs_variable_find(njs_vm_t *vm, njs_parser_node_t *node,
             /* A global scope. */
             vs->scope = scope;
 
+            /* Variables of the previous compilations in accumulative mode. */
+
+            if (nxt_lvlhsh_find(&vm->variables_hash, &vs->lhq) == NXT_OK) {
+                vs->variable = vs->lhq.value;
+                return NXT_OK;
+            }
+
             return NXT_DECLINED;
         }
 
@@ -47,6 +47,7 @@ njs_variable_t *njs_variable_add(njs_vm_t *vm, njs_parser_t *parser,
     njs_variable_type_t type);
 njs_ret_t njs_variables_scope_reference(njs_vm_t *vm,
     njs_parser_scope_t *scope);
+njs_ret_t njs_variables_global_merge(njs_vm_t *vm, njs_parser_scope_t *scope);
 njs_ret_t njs_name_copy(njs_vm_t *vm, nxt_str_t *dst, nxt_str_t *src);
 
 extern const nxt_lvlhsh_proto_t  njs_variables_hash_proto;
@@ -367,6 +367,74 @@ njs_vmcode_array(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
 }
 
 
+njs_ret_t
+njs_vmcode_object_template(njs_vm_t *vm, njs_value_t *invld1,
+    njs_value_t *invld2)
+{
+    size_t                        size;
+    nxt_int_t                     ret;
+    njs_object_t                  *object;
+    njs_object_prop_t             *prop;
+    njs_object_template_t         *template;
+    njs_vmcode_object_template_t  *code;
+
+    code = (njs_vmcode_object_template_t *) vm->current;
+    template = code->template;
+
+    object = njs_object_alloc(vm);
+    if (nxt_slow_path(object == NULL)) {
+        return NXT_ERROR;
+    }
+
+    size = template->items * sizeof(njs_object_prop_t);
+
+    prop = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t), size);
+    if (nxt_slow_path(prop == NULL)) {
+        njs_memory_error(vm);
+        return NXT_ERROR;
+    }
+
+    memcpy(prop, template->properties, size);
+
+    ret = njs_object_hash_create(vm, &object->hash, prop, template->items);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return NXT_ERROR;
+    }
+
+    vm->retval.data.u.object = object;
+    vm->retval.type = NJS_OBJECT;
+    vm->retval.data.truth = 1;
+
+    return sizeof(njs_vmcode_object_template_t);
+}
+
+
+njs_ret_t
+njs_vmcode_array_template(njs_vm_t *vm, njs_value_t *invld1,
+    njs_value_t *invld2)
+{
+    njs_array_t                  *array, *template;
+    njs_vmcode_array_template_t  *code;
+
+    code = (njs_vmcode_array_template_t *) vm->current;
+    template = code->template;
+
+    array = njs_array_alloc(vm, template->length, NJS_ARRAY_SPARE);
+    if (nxt_slow_path(array == NULL)) {
+        return NXT_ERROR;
+    }
+
+    memcpy(array->start, template->start,
+           template->length * sizeof(njs_value_t));
+
+    vm->retval.data.u.array = array;
+    vm->retval.type = NJS_ARRAY;
+    vm->retval.data.truth = 1;
+
+    return sizeof(njs_vmcode_array_template_t);
+}
+
+
 njs_ret_t
 njs_vmcode_function(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
 {
@@ -1400,14 +1468,13 @@ njs_string_concat(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
     size = string1.size + string2.size;
 
-    start = njs_string_alloc(vm, &vm->retval, size, length);
+    start = njs_string_append(vm, &vm->retval, val1, size, length);
 
     if (nxt_slow_path(start == NULL)) {
         return NXT_ERROR;
     }
 
-    (void) memcpy(start, string1.start, string1.size);
-    (void) memcpy(start + string1.size, string2.start, string2.size);
+    (void) memcpy(start, string2.start, string2.size);
 
     return sizeof(njs_vmcode_3addr_t);
 }
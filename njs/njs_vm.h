@@ -18,6 +18,8 @@
 
 #define NJS_MAX_STACK_SIZE       (16 * 1024 * 1024)
 
+#define NJS_ARENA_REGION_SIZE    (32 * 1024)
+
 /*
  * Negative return values handled by nJSVM interpreter as special events.
  * The values must be in range from -1 to -11, because -12 is minimal jump
@@ -162,6 +164,7 @@ typedef njs_ret_t (*njs_function_native_t) (njs_vm_t *vm, njs_value_t *args,
 typedef struct njs_string_s           njs_string_t;
 typedef struct njs_object_s           njs_object_t;
 typedef struct njs_object_init_s      njs_object_init_t;
+typedef struct njs_object_template_s  njs_object_template_t;
 typedef struct njs_object_value_s     njs_object_value_t;
 typedef struct njs_array_s            njs_array_t;
 typedef struct njs_function_lambda_s  njs_function_lambda_t;
@@ -235,7 +238,10 @@ union njs_value_s {
         njs_value_type_t              type:8;  /* 6 bits */
         uint8_t                       truth;
 
-        /* 0xff if data is external string. */
+        /*
+         * 0xff if data is external string, NJS_STRING_BUFFER
+         * if data can be appended in place.
+         */
         uint8_t                       external;
         uint8_t                       _spare;
 
@@ -392,6 +398,7 @@ typedef struct {
         .data = & (njs_string_t) {                                            \
             .start = (u_char *) s,                                            \
             .length = nxt_length(s),                                          \
+            .hash = NJS_STRING_HASH_STATIC,                                   \
         }                                                                     \
     }                                                                         \
 }
@@ -648,6 +655,20 @@ typedef struct {
 } njs_vmcode_array_t;
 
 
+typedef struct {
+    njs_vmcode_t               code;
+    njs_index_t                retval;
+    njs_object_template_t      *template;
+} njs_vmcode_object_template_t;
+
+
+typedef struct {
+    njs_vmcode_t               code;
+    njs_index_t                retval;
+    njs_array_t                *template;
+} njs_vmcode_array_template_t;
+
+
 typedef struct {
     njs_vmcode_t               code;
     njs_index_t                retval;
@@ -1004,6 +1025,14 @@ typedef struct {
 } njs_function_debug_t;
 
 
+typedef struct {
+    const u_char              *start;
+    const u_char              *end;
+    const u_char              *position;
+    uint32_t                  index;
+} njs_string_cursor_t;
+
+
 struct njs_vm_s {
     /* njs_vm_t must be aligned to njs_value_t due to scratch value. */
     njs_value_t              retval;
@@ -1032,6 +1061,16 @@ struct njs_vm_s {
     nxt_lvlhsh_t             values_hash;
     nxt_lvlhsh_t             modules_hash;
 
+    /* Property names interned by njs_string_atom(). */
+    nxt_lvlhsh_t             atoms;
+    nxt_uint_t               natoms;
+
+    /*
+     * The modules are shared with cloned VMs, a cloned VM keeps here
+     * its own copies of the modules required by the VM.
+     */
+    nxt_lvlhsh_t             cloned_modules_hash;
+
     uint32_t                 event_id;
     nxt_lvlhsh_t             events_hash;
     nxt_queue_t              posted_events;
@@ -1048,6 +1087,12 @@ struct njs_vm_s {
 
     nxt_mem_cache_pool_t     *mem_cache_pool;
 
+    /*
+     * Parser nodes, scopes, and other compiler data which are not
+     * needed after code generation.
+     */
+    nxt_mem_cache_pool_t     *compile_pool;
+
     njs_value_t              *global_scope;
     size_t                   scope_size;
     size_t                   stack_size;
@@ -1058,6 +1103,12 @@ struct njs_vm_s {
     nxt_regex_context_t      *regex_context;
     nxt_regex_match_data_t   *single_match_data;
 
+    /* The prepared search of a long string, see njs_string_search(). */
+    nxt_twoway_t             *twoway;
+
+    /* The last character found in a long string, see njs_string_offset(). */
+    njs_string_cursor_t      cursor;
+
     /*
      * MemoryError is statically allocated immutable Error object
      * with the generic type NJS_OBJECT_INTERNAL_ERROR.
@@ -1073,6 +1124,12 @@ struct njs_vm_s {
     nxt_array_t              *backtrace;
 
     njs_trap_t               trap:8;
+
+    /*
+     * A cloned VM shares the compiled state with its parent VM
+     * and must not change it.
+     */
+    uint8_t                  cloned;  /* 1 bit */
 };
 
 
@@ -1083,7 +1140,6 @@ typedef struct {
 
 
 struct njs_vm_shared_s {
-    nxt_lvlhsh_t             keywords_hash;
     nxt_lvlhsh_t             values_hash;
     nxt_lvlhsh_t             function_prototype_hash;
 
@@ -1110,6 +1166,10 @@ njs_ret_t njs_vmcode_object(njs_vm_t *vm, njs_value_t *inlvd1,
     njs_value_t *inlvd2);
 njs_ret_t njs_vmcode_array(njs_vm_t *vm, njs_value_t *inlvd1,
     njs_value_t *inlvd2);
+njs_ret_t njs_vmcode_object_template(njs_vm_t *vm, njs_value_t *inlvd1,
+    njs_value_t *inlvd2);
+njs_ret_t njs_vmcode_array_template(njs_vm_t *vm, njs_value_t *inlvd1,
+    njs_value_t *inlvd2);
 njs_ret_t njs_vmcode_function(njs_vm_t *vm, njs_value_t *inlvd1,
     njs_value_t *invld2);
 njs_ret_t njs_vmcode_regexp(njs_vm_t *vm, njs_value_t *inlvd1,
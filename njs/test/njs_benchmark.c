@@ -5,16 +5,22 @@
  */
 
 #include <njs.h>
+#include <nxt_mem_cache_pool.h>
+#include <nxt_utf8.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <sys/resource.h>
 #include <time.h>
 
+#if (NXT_HAVE_PTHREAD)
+#include <pthread.h>
+#endif
+
 
 static nxt_int_t
 njs_unit_test_benchmark(nxt_str_t *script, nxt_str_t *result, const char *msg,
-    nxt_uint_t n)
+    nxt_uint_t n, nxt_bool_t arena)
 {
     u_char         *start;
     njs_vm_t       *vm, *nvm;
@@ -28,6 +34,8 @@ njs_unit_test_benchmark(nxt_str_t *script, nxt_str_t *result, const char *msg,
 
     nxt_memzero(&options, sizeof(njs_vm_opt_t));
 
+    options.arena = arena;
+
     vm = NULL;
     nvm = NULL;
     rc = NXT_ERROR;
@@ -103,9 +111,361 @@ done:
 }
 
 
+static nxt_int_t
+njs_vm_create_benchmark(const char *msg, nxt_uint_t n)
+{
+    njs_vm_t       *vm;
+    uint64_t       us;
+    nxt_uint_t     i;
+    njs_vm_opt_t   options;
+    struct rusage  usage;
+
+    for (i = 0; i < n; i++) {
+        nxt_memzero(&options, sizeof(njs_vm_opt_t));
+
+        vm = njs_vm_create(&options);
+        if (vm == NULL) {
+            printf("njs_vm_create() failed\n");
+            return NXT_ERROR;
+        }
+
+        njs_vm_destroy(vm);
+    }
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    us = usage.ru_utime.tv_sec * 1000000 + usage.ru_utime.tv_usec
+         + usage.ru_stime.tv_sec * 1000000 + usage.ru_stime.tv_usec;
+
+    printf("%s: %.3fµs, %d times/s\n",
+           msg, (double) us / n, (int) ((uint64_t) n * 1000000 / us));
+
+    return NXT_OK;
+}
+
+
+/*
+ * The benchmark feeds a VM in the accumulative mode line by line as
+ * the interactive shell does, every line declares a new global variable
+ * and references the previous ones.
+ */
+
+static nxt_int_t
+njs_accumulative_benchmark(const char *msg, nxt_uint_t n)
+{
+    u_char         *start;
+    njs_vm_t       *vm;
+    uint64_t       us;
+    nxt_int_t      ret, rc;
+    nxt_str_t      s;
+    nxt_uint_t     i;
+    njs_vm_opt_t   options;
+    struct rusage  usage;
+    u_char         line[128];
+
+    nxt_memzero(&options, sizeof(njs_vm_opt_t));
+
+    options.accumulative = 1;
+
+    rc = NXT_ERROR;
+
+    vm = njs_vm_create(&options);
+    if (vm == NULL) {
+        printf("njs_vm_create() failed\n");
+        return NXT_ERROR;
+    }
+
+    for (i = 0; i < n; i++) {
+        s.start = line;
+        s.length = snprintf((char *) line, sizeof(line),
+                            "var v%d = %d; v%d + v0", (int) i, (int) i,
+                            (int) (i / 2));
+
+        start = s.start;
+
+        ret = njs_vm_compile(vm, &start, start + s.length);
+        if (ret != NXT_OK) {
+            printf("njs_vm_compile() failed\n");
+            goto done;
+        }
+
+        ret = njs_vm_run(vm);
+        if (ret != NXT_OK) {
+            printf("njs_vm_run() failed\n");
+            goto done;
+        }
+
+        if (njs_vm_retval_to_ext_string(vm, &s) != NXT_OK) {
+            printf("njs_vm_retval_to_ext_string() failed\n");
+            goto done;
+        }
+    }
+
+    if (s.length != (size_t) snprintf((char *) line, sizeof(line), "%d",
+                                      (int) ((n - 1) / 2))
+        || memcmp(s.start, line, s.length) != 0)
+    {
+        printf("failed: \"%.*s\"\n", (int) s.length, s.start);
+        goto done;
+    }
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    us = usage.ru_utime.tv_sec * 1000000 + usage.ru_utime.tv_usec
+         + usage.ru_stime.tv_sec * 1000000 + usage.ru_stime.tv_usec;
+
+    printf("%s, %d lines: %.3fµs per line\n", msg, (int) n, (double) us / n);
+
+    rc = NXT_OK;
+
+done:
+
+    njs_vm_destroy(vm);
+
+    return rc;
+}
+
+
+typedef struct {
+    const char     *name;
+    const char     *text;
+} njs_utf8_sample_t;
+
+
+static nxt_int_t
+njs_utf8_length_benchmark(const char *msg, nxt_uint_t n)
+{
+    u_char         *buf;
+    size_t         len, size;
+    ssize_t        length, expected;
+    uint64_t       us;
+    nxt_uint_t     i, k;
+    struct rusage  start, end;
+
+    static const njs_utf8_sample_t  samples[] = {
+        { "ASCII", "GET /index.html HTTP/1.1\r\n" },
+        { "Cyrillic", "Съешь же ещё этих мягких булок. " },
+        { "CJK", "中文字符测试" },
+    };
+
+    for (k = 0; k < nxt_nitems(samples); k++) {
+        len = strlen(samples[k].text);
+        size = 1024 * 1024 / len * len;
+
+        buf = malloc(size);
+        if (buf == NULL) {
+            printf("malloc() failed\n");
+            return NXT_ERROR;
+        }
+
+        for (i = 0; i < size; i += len) {
+            memcpy(&buf[i], samples[k].text, len);
+        }
+
+        expected = nxt_utf8_length((u_char *) samples[k].text, len)
+                   * (size / len);
+        length = 0;
+
+        getrusage(RUSAGE_SELF, &start);
+
+        for (i = 0; i < n; i++) {
+            length = nxt_utf8_length(buf, size);
+        }
+
+        getrusage(RUSAGE_SELF, &end);
+
+        free(buf);
+
+        if (length != expected) {
+            printf("failed: %zd vs %zd\n", length, expected);
+            return NXT_ERROR;
+        }
+
+        us = (end.ru_utime.tv_sec - start.ru_utime.tv_sec) * 1000000
+             + end.ru_utime.tv_usec - start.ru_utime.tv_usec
+             + (end.ru_stime.tv_sec - start.ru_stime.tv_sec) * 1000000
+             + end.ru_stime.tv_usec - start.ru_stime.tv_usec;
+
+        printf("%s, %s: %.0f MB/s\n", msg, samples[k].name,
+               (double) size * n / (us + 1));
+    }
+
+    return NXT_OK;
+}
+
+
+#if (NXT_HAVE_PTHREAD)
+
+typedef struct {
+    njs_vm_t       *vm;
+    nxt_str_t      *result;
+    nxt_uint_t     n;
+    nxt_int_t      rc;
+} njs_benchmark_thread_t;
+
+
+static void *
+njs_benchmark_thread(void *data)
+{
+    njs_vm_t                *nvm;
+    nxt_str_t               s;
+    nxt_uint_t              i;
+    njs_benchmark_thread_t  *ctx;
+
+    ctx = data;
+
+    for (i = 0; i < ctx->n; i++) {
+
+        nvm = njs_vm_clone(ctx->vm, NULL);
+        if (nvm == NULL) {
+            printf("njs_vm_clone() failed\n");
+            return NULL;
+        }
+
+        (void) njs_vm_run(nvm);
+
+        if (njs_vm_retval_to_ext_string(nvm, &s) != NXT_OK) {
+            printf("njs_vm_retval_to_ext_string() failed\n");
+            njs_vm_destroy(nvm);
+            return NULL;
+        }
+
+        if (!nxt_strstr_eq(ctx->result, &s)) {
+            printf("failed: \"%.*s\" vs \"%.*s\"\n",
+                   (int) ctx->result->length, ctx->result->start,
+                   (int) s.length, s.start);
+            njs_vm_destroy(nvm);
+            return NULL;
+        }
+
+        njs_vm_destroy(nvm);
+    }
+
+    njs_vm_thread_cache_flush();
+
+    ctx->rc = NXT_OK;
+
+    return NULL;
+}
+
+
+/*
+ * The benchmark clones VMs from one parent VM concurrently in several
+ * threads to stress the read-only state shared by cloned VMs.
+ */
+
+static nxt_int_t
+njs_threads_benchmark(nxt_str_t *script, nxt_str_t *result, const char *msg,
+    nxt_uint_t n, nxt_uint_t nthreads)
+{
+    u_char                  *start;
+    njs_vm_t                *vm;
+    uint64_t                ns;
+    nxt_int_t               ret, rc;
+    nxt_uint_t              i, started;
+    njs_vm_opt_t            options;
+    struct timespec         begin, end;
+    njs_benchmark_thread_t  *ctx;
+    pthread_t               threads[16];
+
+    nxt_memzero(&options, sizeof(njs_vm_opt_t));
+
+    nthreads = nxt_max(1, nxt_min(nthreads, 16));
+
+    rc = NXT_ERROR;
+    started = 0;
+    ctx = NULL;
+
+    vm = njs_vm_create(&options);
+    if (vm == NULL) {
+        printf("njs_vm_create() failed\n");
+        goto done;
+    }
+
+    start = script->start;
+
+    ret = njs_vm_compile(vm, &start, start + script->length);
+    if (ret != NXT_OK) {
+        printf("njs_vm_compile() failed\n");
+        goto done;
+    }
+
+    ctx = calloc(nthreads, sizeof(njs_benchmark_thread_t));
+    if (ctx == NULL) {
+        goto done;
+    }
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    for (i = 0; i < nthreads; i++) {
+        ctx[i].vm = vm;
+        ctx[i].result = result;
+        ctx[i].n = n / nthreads;
+        ctx[i].rc = NXT_ERROR;
+
+        if (pthread_create(&threads[i], NULL, njs_benchmark_thread, &ctx[i])
+            != 0)
+        {
+            printf("pthread_create() failed\n");
+            goto done;
+        }
+
+        started++;
+    }
+
+    rc = NXT_OK;
+
+    for (i = 0; i < started; i++) {
+        (void) pthread_join(threads[i], NULL);
+
+        if (ctx[i].rc != NXT_OK) {
+            rc = NXT_ERROR;
+        }
+    }
+
+    started = 0;
+
+    if (rc != NXT_OK) {
+        goto done;
+    }
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &end);
+
+    ns = (end.tv_sec - begin.tv_sec) * 1000000000
+         + end.tv_nsec - begin.tv_nsec;
+
+    n = nthreads * (n / nthreads);
+
+    printf("%s, %d threads: %.3fµs, %d times/s\n", msg, (int) nthreads,
+           (double) ns / 1000 / n, (int) ((uint64_t) n * 1000000000 / ns));
+
+done:
+
+    for (i = 0; i < started; i++) {
+        (void) pthread_join(threads[i], NULL);
+    }
+
+    if (ctx != NULL) {
+        free(ctx);
+    }
+
+    if (vm != NULL) {
+        njs_vm_destroy(vm);
+    }
+
+    return rc;
+}
+
+#endif
+
+
 int nxt_cdecl
 main(int argc, char **argv)
 {
+#if (NXT_HAVE_PTHREAD)
+    nxt_uint_t  nthreads;
+#endif
+
     static nxt_str_t  script = nxt_string("null");
     static nxt_str_t  result = nxt_string("null");
 
@@ -144,29 +504,228 @@ main(int argc, char **argv)
 
     static nxt_str_t  fibo_result = nxt_string("3524578");
 
+    static nxt_str_t  literals = nxt_string(
+        "var n = 0;"
+        "for (var i = 0; i < 1000000; i++) {"
+        "    var o = { a: 1, b: 'b', c: null, d: true, e: 5 };"
+        "    var a = [1, 2, 3, 4, 5, 6, 7, 8];"
+        "    n += o.e + a[7]"
+        "}"
+        "n");
+
+    static nxt_str_t  literals_result = nxt_string("13000000");
+
+    static nxt_str_t  fragments = nxt_string(
+        "var s = '';"
+        "for (var i = 0; i < 100000; i++) {"
+        "    s += 'fragment ' + i + ';'"
+        "}"
+        "s.length");
+
+    static nxt_str_t  fragments_result = nxt_string("1488890");
+
+    static nxt_str_t  utf8_fragments = nxt_string(
+        "var s = '';"
+        "for (var i = 0; i < 100000; i++) {"
+        "    s += 'fragment é ' + i + ';'"
+        "}"
+        "s.length");
+
+    static nxt_str_t  utf8_fragments_result = nxt_string("1688890");
+
+    static nxt_str_t  keys = nxt_string(
+        "var h = {}, k = [], n = 0;"
+        "for (var i = 0; i < 20; i++) {"
+        "    k[i] = 'x-request-header-name-' + i + '-' + 'abcdefghij';"
+        "    h[k[i]] = i"
+        "}"
+        "for (i = 0; i < 1000000; i++) {"
+        "    n += h[k[i % 20]]"
+        "}"
+        "n");
+
+    static nxt_str_t  keys_result = nxt_string("9500000");
+
+    static nxt_str_t  json = nxt_string(
+        "var r = [], n = 0;"
+        "for (var i = 0; i < 1000; i++) {"
+        "    r.push('{\"request_header_name\":' + i"
+        "           + ',\"response_header_name\":1'"
+        "           + ',\"upstream_response_time\":2}')"
+        "}"
+        "var s = '[' + r.join(',') + ']';"
+        "for (i = 0; i < 100; i++) {"
+        "    var a = JSON.parse(s);"
+        "    for (var j = 0; j < a.length; j++) {"
+        "        n += a[j].request_header_name + a[j].upstream_response_time"
+        "    }"
+        "}"
+        "n");
+
+    static nxt_str_t  json_result = nxt_string("50150000");
+
+    static nxt_str_t  search = nxt_string(
+        "var s = 'abcdefghij'.repeat(10000) + 'needle', n = 0;"
+        "for (var i = 0; i < 1000; i++) {"
+        "    n += s.indexOf('needle') - s.lastIndexOf('abcdefghij')"
+        "}"
+        "n");
+
+    static nxt_str_t  search_result = nxt_string("10000");
+
+    static nxt_str_t  marker = nxt_string(
+        "var m = '<!--#include virtual=\"/footer.html\"-->', n = 0;"
+        "var s = 'lorem ipsum dolor sit amet, '.repeat(150000) + m;"
+        "for (var i = 0; i < 20; i++) {"
+        "    n += s.replace(m, '').length + s.split(m).length"
+        "}"
+        "n");
+
+    static nxt_str_t  marker_result = nxt_string("84000040");
+
+    static nxt_str_t  periodic = nxt_string(
+        "var m = 'a'.repeat(20) + 'b' + 'a'.repeat(19), n = 0;"
+        "var s = 'a'.repeat(1000000);"
+        "for (var i = 0; i < 20; i++) {"
+        "    n += s.indexOf(m) + s.split(m).length"
+        "}"
+        "n");
+
+    static nxt_str_t  periodic_result = nxt_string("0");
+
+    static nxt_str_t  chars = nxt_string(
+        "var s = 'абвгдеёжзийклмнопрстуфхцчшщъыьэюя'.repeat(300), n = 0;"
+        "for (var k = 0; k < 100; k++) {"
+        "    for (var i = 0; i < s.length; i++) {"
+        "        n += s.charCodeAt(i)"
+        "    }"
+        "    for (var j = s.length - 1; j >= 0; j--) {"
+        "        n -= s[j].charCodeAt(0)"
+        "    }"
+        "}"
+        "n");
+
+    static nxt_str_t  chars_result = nxt_string("0");
+
+    static nxt_str_t  cases = nxt_string(
+        "var a = 'Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+        "(KHTML, like Gecko) Chrome/70.0.3538.77 Safari/537.36',"
+        "    u = 'Привет, Мир! ' + a, n = 0;"
+        "for (var i = 0; i < 200000; i++) {"
+        "    n += a.toLowerCase().length + a.toUpperCase().length"
+        "         + u.toLowerCase().length + (' ' + a + ' ').trim().length"
+        "}"
+        "n");
+
+    static nxt_str_t  cases_result = nxt_string("85800000");
+
+    static nxt_str_t  shared = nxt_string(
+        "var s = 'αααααααααααααααααααααααααααααααααααααααβ';"
+        "function f() { return s[39] }"
+        "f.p = 1;"
+        "var r = new RegExp('β+', 'g');"
+        "f() + s.indexOf('β') + /α+/.exec(s)[0].length + r.test(s) + f.p");
+
+    static nxt_str_t  shared_result = nxt_string("β3939true1");
+
 
     if (argc > 1) {
         switch (argv[1][0]) {
 
         case 'v':
             return njs_unit_test_benchmark(&script, &result,
-                                           "nJSVM clone/destroy", 1000000);
+                                           "nJSVM clone/destroy", 1000000, 0);
+
+        case 'c':
+            return njs_vm_create_benchmark("nJSVM create/destroy", 1000000);
+
+        case 'l':
+            return njs_accumulative_benchmark("nJSVM accumulative compile/run",
+                                              10000);
+
+        case 'r':
+            return njs_unit_test_benchmark(&script, &result,
+                                           "nJSVM arena clone/destroy",
+                                           1000000, 1);
 
         case 'n':
             return njs_unit_test_benchmark(&fibo_number, &fibo_result,
-                                           "fibobench numbers", 1);
+                                           "fibobench numbers", 1, 0);
 
         case 'a':
             return njs_unit_test_benchmark(&fibo_ascii, &fibo_result,
-                                           "fibobench ascii strings", 1);
+                                           "fibobench ascii strings", 1, 0);
 
         case 'b':
             return njs_unit_test_benchmark(&fibo_bytes, &fibo_result,
-                                           "fibobench byte strings", 1);
+                                           "fibobench byte strings", 1, 0);
 
         case 'u':
             return njs_unit_test_benchmark(&fibo_utf8, &fibo_result,
-                                           "fibobench utf8 strings", 1);
+                                           "fibobench utf8 strings", 1, 0);
+
+        case 'o':
+            return njs_unit_test_benchmark(&literals, &literals_result,
+                                           "constant object and array literals",
+                                           1, 0);
+
+        case 's':
+            return njs_unit_test_benchmark(&fragments, &fragments_result,
+                                           "concatenation of 100k fragments",
+                                           1, 0);
+
+        case 'f':
+            return njs_unit_test_benchmark(&utf8_fragments,
+                                           &utf8_fragments_result,
+                                           "concatenation of 100k UTF-8 "
+                                           "fragments", 1, 0);
+
+        case 'k':
+            return njs_unit_test_benchmark(&keys, &keys_result,
+                                           "long dynamic property names",
+                                           1, 0);
+
+        case 'i':
+            return njs_unit_test_benchmark(&search, &search_result,
+                                           "indexOf() in a long string",
+                                           1, 0);
+
+        case 'p':
+            return njs_unit_test_benchmark(&marker, &marker_result,
+                                           "replace() of a long marker",
+                                           1, 0);
+
+        case 'w':
+            return njs_unit_test_benchmark(&periodic, &periodic_result,
+                                           "search of a periodic string",
+                                           1, 0);
+
+        case 'g':
+            return njs_unit_test_benchmark(&chars, &chars_result,
+                                           "sequential UTF-8 characters",
+                                           1, 0);
+
+        case 'e':
+            return njs_unit_test_benchmark(&cases, &cases_result,
+                                           "case conversion and trim()",
+                                           1, 0);
+
+        case 'j':
+            return njs_unit_test_benchmark(&json, &json_result,
+                                           "JSON.parse() long property names",
+                                           1, 0);
+
+        case 'd':
+            return njs_utf8_length_benchmark("nxt_utf8_length() of 1MB", 200);
+
+#if (NXT_HAVE_PTHREAD)
+        case 't':
+            nthreads = (argc > 2) ? atoi(argv[2]) : 4;
+
+            return njs_threads_benchmark(&shared, &shared_result,
+                                         "nJSVM threaded clone/run/destroy",
+                                         1000000, nthreads);
+#endif
         }
     }
 
@@ -81,6 +81,19 @@ static njs_interactive_test_t  njs_test[] =
                  "2 + 2" ENTER),
       nxt_string("4") },
 
+    { nxt_string("var a = 1; var b = ;" ENTER
+                 "typeof b" ENTER),
+      nxt_string("undefined") },
+
+    { nxt_string("var a = 1" ENTER
+                 "var a = 2; var b = ;" ENTER
+                 "a" ENTER),
+      nxt_string("1") },
+
+    { nxt_string("function f() { return 1 }; var b = ;" ENTER
+                 "f()" ENTER),
+      nxt_string("ReferenceError: \"f\" is not defined in 1") },
+
     { nxt_string("function f() { return b;" ENTER),
       nxt_string("SyntaxError: Unexpected end of input in 1") },
 
@@ -58,6 +58,21 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("/*\n*/; var + a"),
       nxt_string("SyntaxError: Unexpected token \"+\" in 2") },
 
+    { nxt_string("/* long comment\n with lines \n and * stars **/; var + a"),
+      nxt_string("SyntaxError: Unexpected token \"+\" in 3") },
+
+    { nxt_string("/* unterminated comment */ 1 /* * /"),
+      nxt_string("SyntaxError: Unexpected token \"\" in 1") },
+
+    { nxt_string("        \n                var + a"),
+      nxt_string("SyntaxError: Unexpected token \"+\" in 2") },
+
+    { nxt_string("var s = 'a long string with \"quotes\" and \\'escapes\\''; s"),
+      nxt_string("a long string with \"quotes\" and 'escapes'") },
+
+    { nxt_string("'a long unterminated string"),
+      nxt_string("SyntaxError: Unterminated string \"'a long unterminated string\" in 1") },
+
     { nxt_string("var \n a \n = 1; a"),
       nxt_string("1") },
 
@@ -420,6 +435,24 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("1 + 1 + '2' + 1 + 1"),
       nxt_string("2211") },
 
+    { nxt_string("1 - 2 - 3"),
+      nxt_string("-4") },
+
+    { nxt_string("2 * 3 + 4 * 5 - 6 / 2"),
+      nxt_string("23") },
+
+    { nxt_string("1 + 2 << 3 + 1 | 5 & 6 ^ 1"),
+      nxt_string("53") },
+
+    { nxt_string("1 < 2 == 2 > 1"),
+      nxt_string("true") },
+
+    { nxt_string("0 || 1 && 2 | 4"),
+      nxt_string("6") },
+
+    { nxt_string("1\n\n\n\n\n\n\n\n\n\n\n\n\n\n+ 2\n\n* 3"),
+      nxt_string("7") },
+
     { nxt_string("'gg' + -0"),
       nxt_string("gg0") },
 
@@ -2337,6 +2370,36 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("3 + 'abc' + 'def' + null + true + false + undefined"),
       nxt_string("3abcdefnulltruefalseundefined") },
 
+    { nxt_string("var s = ''; for (var i = 0; i < 1000; i++) { s += i % 10 }"
+                 "s.length +' '+ s.slice(0, 12) +' '+ s.slice(-3)"),
+      nxt_string("1000 012345678901 789") },
+
+    { nxt_string("var s = 'x'.repeat(300) + 'y', a = s + 'a', b = s + 'b';"
+                 "s.length +' '+ a.slice(-3) +' '+ b.slice(-3) +' '+ (s + s)"
+                 ".slice(299, 302)"),
+      nxt_string("301 xya xyb xyx") },
+
+    { nxt_string("var s = 'x'.repeat(300) + 'y', a = s + 'a';"
+                 "s += 'α'; s += s; s.length +' '+ s[301] +' '+ s[603]"
+                 "+' '+ a.length"),
+      nxt_string("604 α α 302") },
+
+    { nxt_string("var s = 'x'.repeat(300) + 'y'; s += '\\x80'.toBytes();"
+                 "s += 'z'; s.length +' '+ s.slice(-2).toString('hex')"),
+      nxt_string("303 807a") },
+
+    { nxt_string("var s = ''; for (var i = 0; i < 200; i++) { s += 'αβγ' + i }"
+                 "var t = s; s += 'ω';"
+                 "t.length +' '+ s.length +' '+ s[701] + s[100] + s[1002]"
+                 "+ s[s.length - 1] +' '+ s.indexOf('199') +' '"
+                 "+ s.lastIndexOf('γ19') +' '+ t[t.length - 1] +' '"
+                 "+ s.slice(995, 1000) +' '+ s.charCodeAt(64)"),
+      nxt_string("1090 1091 βαγω 1087 1086 9 βγ184 52") },
+
+    { nxt_string("var s = ''; for (var i = 0; i < 200; i++) { s += 'αβγ' + i }"
+                 "var r = /γ1/g; r.exec(s); r.exec(s); r.lastIndex"),
+      nxt_string("44") },
+
     { nxt_string("var a = 0; do a++; while (a < 5) if (a == 5) a = 7.33 \n"
                  "else a = 8; while (a < 10) a++; a"),
       nxt_string("10.33") },
@@ -2573,6 +2636,40 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("var x = { a: 1 }, b = delete x.a; x.a +' '+ b"),
       nxt_string("undefined true") },
 
+    { nxt_string("var o = { a: 1, b: 'b', 1: null, a: true, '2': 3.5 };"
+                 "JSON.stringify(o) +' '+ Object.keys(o)"),
+      nxt_string("{\"a\":true,\"b\":\"b\",\"1\":null,\"2\":3.5} a,b,1,2") },
+
+    { nxt_string("function f() { return { a: 1, b: [1, 2] } }"
+                 "var x = f(); x.a = 2; x.c = 3; x.b.push(3);"
+                 "var y = f(); y.a +' '+ y.c +' '+ y.b"),
+      nxt_string("1 undefined 1,2") },
+
+    { nxt_string("var s = ''; for (var i = 0; i < 3; i++) {"
+                 "var o = { n: 0 }; o.n += i; s += o.n } s"),
+      nxt_string("012") },
+
+    { nxt_string("var o = { a: 1 }; delete o.a; o.a = 2;"
+                 "Object.getOwnPropertyDescriptor(o, 'a').writable"),
+      nxt_string("true") },
+
+    { nxt_string("var o = { __proto__: null }"),
+      nxt_string("TypeError: Cannot assign to read-only property '__proto__' "
+                 "of object") },
+
+    { nxt_string("function f() { return [1, , 3, 'a', , ] }"
+                 "var a = f(); a[1] = 2; a.length = 1;"
+                 "var b = f(); b.length +' '+ (1 in b) +' '+ b"),
+      nxt_string("5 false 1,,3,a,") },
+
+    { nxt_string("function f() { return { 'a long property name': 'a long "
+                 "property value', 1234567890123456: ['a long array value'] } }"
+                 "var o = f(), p = f(); delete o['a long property name'];"
+                 "p['a long property' + ' name'] +' '+ o[1234567890123456]"
+                 "+' '+ Object.keys(o)"),
+      nxt_string("a long property value a long array value "
+                 "1234567890123456") },
+
     { nxt_string("delete null"),
       nxt_string("true") },
 
@@ -3770,6 +3867,20 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("('abc' + 'defgh').substr(1, 4)"),
       nxt_string("bcde") },
 
+    { nxt_string("var s = 'abcdefghij'.repeat(10), a = s.substr(5, 40);"
+                 "a.length +' '+ a.slice(0, 5) +' '+ a[39] +' '+ s.length"),
+      nxt_string("40 fghij e 100") },
+
+    { nxt_string("var s = 'α'.repeat(50) + 'β'.repeat(50) + 'γ'.repeat(50),"
+                 "    a = s.substring(20, 120);"
+                 "a.length +' '+ a[29] + a[30] + a[79] + a[80] +' '+ a.indexOf('γ')"),
+      nxt_string("100 αββγ 80") },
+
+    { nxt_string("var s = 'α'.repeat(40) + '-' + 'β'.repeat(40),"
+                 "    a = s.split('-');"
+                 "a[0].length +' '+ a[0][39] + a[1][0] +' '+ a[0].lastIndexOf('α')"),
+      nxt_string("40 αβ 39") },
+
     { nxt_string("'abcdefghijklmno'.substring(3, 5)"),
       nxt_string("de") },
 
@@ -4090,6 +4201,28 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("'12345абвгдеёжзийклмнопрстуфхцчшщъыьэюя'.charCodeAt(35)"),
       nxt_string("1101") },
 
+    { nxt_string("var c = [], s = '', n = 0, i, k;"
+                 "for (i = 0; i < 500; i++) {"
+                 "    c[i] = [0x61, 0x3B1, 0x4E00][i % 7 % 3] + i % 17;"
+                 "    s += String.fromCharCode(c[i]);"
+                 "}"
+                 "var t = s.slice(1);"
+                 "for (k = 1; k < 40; k += 6) {"
+                 "    for (i = 0; i < 500; i += k) {"
+                 "        n += (s.charCodeAt(i) !== c[i]);"
+                 "    }"
+                 "    for (i = 498; i >= 0; i -= k) {"
+                 "        n += (s[i] !== String.fromCharCode(c[i]));"
+                 "        n += (t.charCodeAt(i) !== c[i + 1]);"
+                 "    }"
+                 "}"
+                 "for (i = 0; i < 1000; i++) {"
+                 "    k = (i * 7919) % 500;"
+                 "    n += (s.charAt(k) !== String.fromCharCode(c[k]));"
+                 "}"
+                 "[n, s.slice(100, 103) === t.slice(99, 102), s.length]"),
+      nxt_string("0,true,500") },
+
     { nxt_string("'12345абвгдеёжзийклмнопрстуфхцчшщъыьэюя'.substring(35)"),
       nxt_string("эюя") },
 
@@ -4237,6 +4370,37 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("'абв абв абвгдежз'.includes('абвгд', 9)"),
       nxt_string("false") },
 
+    { nxt_string("var s = 'ab'.repeat(40) + 'abc' + 'ab'.repeat(40);"
+                 "[s.indexOf('abc'), s.lastIndexOf('abc'), s.indexOf('abc', 81),"
+                 " s.lastIndexOf('abc', 79), s.includes('bab'), s.indexOf('bb')]"),
+      nxt_string("80,80,-1,-1,true,-1") },
+
+    { nxt_string("var s = 'αβ'.repeat(40) + 'αβγ' + 'αβ'.repeat(40);"
+                 "[s.indexOf('βγ'), s.lastIndexOf('αβ'), s.lastIndexOf('αβ', 100),"
+                 " s.indexOf('γ', 83), s.includes('γα')]"),
+      nxt_string("81,161,99,-1,true") },
+
+    { nxt_string("var s = 'αβγ'.repeat(10), b = '\\xB2'.toBytes();"
+                 "[s.indexOf(b), s.lastIndexOf(b), s.includes(b)]"),
+      nxt_string("-1,-1,false") },
+
+    { nxt_string("[('ab'.repeat(40) + 'abc').replace('abc', 'X').slice(-3),"
+                 " ('αβ'.repeat(20) + 'γ').replace('βγ', 'X').slice(-3),"
+                 " ('abc,'.repeat(20) + 'x').split(',').length,"
+                 " 'ab'.repeat(20).split('ba').length]"),
+      nxt_string("abX,βαX,21,20") },
+
+    { nxt_string("var s = 'ab'.repeat(1000) + 'abc' + 'ab'.repeat(1000),"
+                 "    m = 'ab'.repeat(20) + 'c', m2 = 'ba'.repeat(20) + 'c';"
+                 "[s.indexOf(m), s.indexOf(m2), s.split(m).length,"
+                 " s.replace(m, '').length, s.includes(m2), s.indexOf(m, 1963)]"),
+      nxt_string("1962,-1,2,3962,false,-1") },
+
+    { nxt_string("var s = 'αβ'.repeat(1000) + 'γ' + 'αβ'.repeat(1000),"
+                 "    m = 'αβ'.repeat(20) + 'γ';"
+                 "[s.indexOf(m), s.replace(m, 'x').length, s.split(m)[1].length]"),
+      nxt_string("1960,3961,2000") },
+
     { nxt_string("''.startsWith('')"),
       nxt_string("true") },
 
@@ -4300,6 +4464,27 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("'абв'.toUpperCase()"),
       nxt_string("АБВ") },
 
+    { nxt_string("var s = '@AZ[`az{'.repeat(10) + 'Ab';"
+                 "[s.toLowerCase() === '@az[`az{'.repeat(10) + 'ab',"
+                 " s.toUpperCase() === '@AZ[`AZ{'.repeat(10) + 'AB']"),
+      nxt_string("true,true") },
+
+    { nxt_string("var s = '', l = '', u = '', i, c;"
+                 "for (i = 0; i < 600; i++) {"
+                 "    c = String.fromCharCode(i % 7 ? 32 + i % 95"
+                 "                                  : 0x391 + i % 25);"
+                 "    s += c; l += c.toLowerCase(); u += c.toUpperCase();"
+                 "}"
+                 "[s.toLowerCase() === l, s.toUpperCase() === u,"
+                 " s.toLowerCase().length, s.toUpperCase().length]"),
+      nxt_string("true,true,600,600") },
+
+    { nxt_string("var b = ('\\xC0ABC\\xE0abc' + 'Ab'.repeat(10)).toBytes();"
+                 "[b.toLowerCase().toString('hex').slice(0, 16),"
+                 " b.toUpperCase().toString('hex').slice(0, 16),"
+                 " b.toLowerCase().slice(8)]"),
+      nxt_string("c0616263e0616263,c0414243e0414243,abababababababababab") },
+
     { nxt_string("var a = [], code;"
                  "for (code = 0; code <= 1114111; code++) {"
                  "    var s = String.fromCharCode(code);"
@@ -4348,6 +4533,14 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("'\\u2029abc\\uFEFF\\u2028'.trim()"),
       nxt_string("abc") },
 
+    { nxt_string("' \\t\\n αβγ \\r '.trim() + '|'"
+                 "+ '\\u2028 αβγ\\u00A0'.trim()"),
+      nxt_string("αβγ|αβγ") },
+
+    { nxt_string("var b = '\\t\\xA0' + 'ab'.repeat(20) + ' \\xA0';"
+                 "b.toBytes().trim().length"),
+      nxt_string("40") },
+
     { nxt_string("'abcdefgh'.search()"),
       nxt_string("0") },
 
@@ -5605,6 +5798,10 @@ static njs_unit_test_t  njs_test[] =
                  "r.source +' '+ r.source.length +' '+ r"),
       nxt_string("3 БВ бв 2 /бв/gi") },
 
+    { nxt_string("var a = /(α+)(β+)/.exec('α'.repeat(40) + 'β'.repeat(40));"
+                 "a[1].length +' '+ a[1][39] + a[2][39] +' '+ a[1].indexOf('β')"),
+      nxt_string("40 αβ -1") },
+
     { nxt_string("var r = /\\x80/g; r.exec('\\u0081\\u0080'.toBytes());"
                  "r.lastIndex +' '+ r.source +' '+ r.source.length +' '+ r"),
       nxt_string("1 \\x80 4 /\\x80/g") },
@@ -6895,6 +7092,12 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("Object.defineProperties({}, 1)"),
       nxt_string("TypeError: descriptor is not an object") },
 
+    { nxt_string("var o = {}, k = 'long-property-name-';"
+                 "for (var i = 0; i < 3; i++) { o[k + i] = i; o[k + i] += o[k + i] }"
+                 "o[k + 2] +' '+ o['long-property-name-1'] +' '+ o[k] +' '+"
+                 "o.hasOwnProperty(k + 0) +' '+ Object.keys(o)[2]"),
+      nxt_string("4 2 undefined true long-property-name-2") },
+
     { nxt_string("var o = {a:1}; o.hasOwnProperty('a')"),
       nxt_string("true") },
 
@@ -8924,6 +9127,28 @@ static njs_unit_test_t  njs_test[] =
                  "o.b = 3; o.b"),
       nxt_string("3") },
 
+    { nxt_string("var a = JSON.parse('[{\"long_property_name_1\":1,"
+                 "                      \"long_property_name_2\":2},"
+                 "                     {\"long_property_name_2\":3,"
+                 "                      \"long_property_\\\\u006eame_1\":4}]');"
+                 "[a[0].long_property_name_1, a[1].long_property_name_1,"
+                 " a[1][Object.keys(a[0])[1]], Object.keys(a[1])]"),
+      nxt_string("1,4,3,long_property_name_2,long_property_name_1") },
+
+    { nxt_string("var k = 'α'.repeat(40);"
+                 "var o = JSON.parse('{\"' + k + '\":1,\"' + k + '\":2}');"
+                 "[o[k], Object.keys(o).length, Object.keys(o)[0].length]"),
+      nxt_string("2,1,40") },
+
+    { nxt_string("var a = [];"
+                 "for (var i = 0; i < 5000; i++) {"
+                 "    a.push('\"long_property_name_' + i + '\":' + i) }"
+                 "var o = JSON.parse('{' + a.join() + '}');"
+                 "var b = JSON.parse('[{' + a.join() + '}]')[0];"
+                 "Object.keys(o).length +' '+ o.long_property_name_4999 +' '"
+                 "+ b.long_property_name_4500 +' '+ Object.keys(b).length"),
+      nxt_string("5000 4999 4500 5000") },
+
     { nxt_string("var o = JSON.parse('{}', function(k, v) {return v;}); o"),
       nxt_string("[object Object]") },
 
@@ -9450,6 +9675,12 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("var fs = require('fs'); typeof fs"),
       nxt_string("object") },
 
+    { nxt_string("require('crypto') === require('crypto')"),
+      nxt_string("true") },
+
+    { nxt_string("Object.getPrototypeOf(require('fs')) === Object.prototype"),
+      nxt_string("true") },
+
     /* require('fs').readFile() */
 
     { nxt_string("var fs = require('fs');"
@@ -10288,8 +10519,8 @@ njs_externals_init(njs_vm_t *vm)
 
 
 static nxt_int_t
-njs_unit_test(njs_unit_test_t tests[], size_t num, nxt_bool_t disassemble,
-    nxt_bool_t verbose)
+njs_unit_test(njs_unit_test_t tests[], size_t num, nxt_bool_t arena,
+    nxt_bool_t disassemble, nxt_bool_t verbose)
 {
     u_char        *start;
     njs_vm_t      *vm, *nvm;
@@ -10314,6 +10545,8 @@ njs_unit_test(njs_unit_test_t tests[], size_t num, nxt_bool_t disassemble,
 
         nxt_memzero(&options, sizeof(njs_vm_opt_t));
 
+        options.arena = arena;
+
         vm = njs_vm_create(&options);
         if (vm == NULL) {
             printf("njs_vm_create() failed\n");
@@ -10431,6 +10664,256 @@ njs_vm_object_alloc_test(njs_vm_t * vm, nxt_bool_t disassemble,
 }
 
 
+typedef struct {
+    nxt_uint_t  allocated;
+    nxt_uint_t  freed;
+    size_t      alignment;
+} njs_unit_test_mem_t;
+
+
+static void *
+njs_unit_test_mem_alloc(void *mem, size_t size)
+{
+    ((njs_unit_test_mem_t *) mem)->allocated++;
+
+    return nxt_malloc(size);
+}
+
+
+static void *
+njs_unit_test_mem_zalloc(void *mem, size_t size)
+{
+    void  *p;
+
+    p = njs_unit_test_mem_alloc(mem, size);
+
+    if (p != NULL) {
+        nxt_memzero(p, size);
+    }
+
+    return p;
+}
+
+
+static void *
+njs_unit_test_mem_align(void *mem, size_t alignment, size_t size)
+{
+    njs_unit_test_mem_t  *m;
+
+    m = mem;
+
+    m->allocated++;
+    m->alignment = nxt_max(m->alignment, alignment);
+
+    return nxt_memalign(alignment, size);
+}
+
+
+static void
+njs_unit_test_mem_free(void *mem, void *p)
+{
+    ((njs_unit_test_mem_t *) mem)->freed++;
+
+    nxt_free(p);
+}
+
+
+static const nxt_mem_proto_t  njs_unit_test_mem_proto = {
+    njs_unit_test_mem_alloc,
+    njs_unit_test_mem_zalloc,
+    njs_unit_test_mem_align,
+    NULL,
+    njs_unit_test_mem_free,
+    NULL,
+    NULL,
+};
+
+
+static nxt_int_t
+njs_vm_clone_mem_test(njs_vm_t * vm, nxt_bool_t disassemble,
+    nxt_bool_t verbose)
+{
+    u_char               *start;
+    njs_vm_t             *nvm;
+    nxt_int_t            ret;
+    nxt_str_t            s;
+    njs_unit_test_mem_t  mem;
+
+    /* Array growth frees memory to the allocator. */
+
+    static nxt_str_t  script = nxt_string(
+                          "var s = 'α'.repeat(1000), a = [];"
+                          "for (var i = 0; i < 10000; i++) { a.push(s + i) }"
+                          "a.length +' '+ a[9999].length");
+    static nxt_str_t  result = nxt_string("10000 1004");
+
+    start = script.start;
+
+    ret = njs_vm_compile(vm, &start, start + script.length);
+    if (ret != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    nxt_memzero(&mem, sizeof(njs_unit_test_mem_t));
+
+    nvm = njs_vm_clone_mem(vm, NULL, &njs_unit_test_mem_proto, &mem);
+    if (nvm == NULL) {
+        return NXT_ERROR;
+    }
+
+    ret = njs_vm_run(nvm);
+
+    if (ret == NXT_OK) {
+        ret = njs_vm_retval_to_ext_string(nvm, &s);
+
+        if (ret == NXT_OK && !nxt_strstr_eq(&result, &s)) {
+            ret = NXT_ERROR;
+        }
+    }
+
+    njs_vm_destroy(nvm);
+
+    if (mem.allocated == 0 || mem.allocated != mem.freed) {
+        return NXT_ERROR;
+    }
+
+    /* Clusters are aligned to their size, see njs_vm_opt_t.mem_proto. */
+
+    if (mem.alignment < (size_t) (2 * nxt_pagesize())) {
+        return NXT_ERROR;
+    }
+
+    return ret;
+}
+
+
+static nxt_int_t
+njs_vm_external_string_test(njs_vm_t * vm, nxt_bool_t disassemble,
+    nxt_bool_t verbose)
+{
+    nxt_int_t    ret;
+    nxt_str_t    s;
+    njs_value_t  value;
+
+    static u_char  data[] = "an external string longer than a short string";
+
+    /* A long string refers to the host memory. */
+
+    ret = njs_vm_external_string_create(vm, &value, data, sizeof(data) - 1);
+    if (ret != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    ret = njs_vm_value_to_ext_string(vm, &s, &value, 0);
+    if (ret != NXT_OK || s.start != data || s.length != sizeof(data) - 1) {
+        return NXT_ERROR;
+    }
+
+    /* A short string is copied. */
+
+    ret = njs_vm_external_string_create(vm, &value, data, 11);
+    if (ret != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    ret = njs_vm_value_to_ext_string(vm, &s, &value, 0);
+    if (ret != NXT_OK || s.start == data
+        || s.length != 11 || memcmp(s.start, data, 11) != 0)
+    {
+        return NXT_ERROR;
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_vm_compile_once_test(njs_vm_t * vm, nxt_bool_t disassemble,
+    nxt_bool_t verbose)
+{
+    u_char  *start;
+
+    static nxt_str_t  bad = nxt_string("var a = ;");
+    static nxt_str_t  good = nxt_string("var a = 1");
+
+    /* A script can be compiled again after a failed compilation. */
+
+    start = bad.start;
+
+    if (njs_vm_compile(vm, &start, start + bad.length) == NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    start = good.start;
+
+    if (njs_vm_compile(vm, &start, start + good.length) != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    /* A non-accumulative VM cannot compile another script. */
+
+    start = good.start;
+
+    if (njs_vm_compile(vm, &start, start + good.length) == NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+njs_lexer_keyword_test(njs_vm_t * vm, nxt_bool_t disassemble,
+    nxt_bool_t verbose)
+{
+    nxt_uint_t           i, n;
+    njs_token_t          token;
+    njs_lexer_t          lexer;
+    const njs_keyword_t  *keyword;
+
+    static const nxt_str_t  names[] = {
+        nxt_string("i"),
+        nxt_string("ins"),
+        nxt_string("Infinit"),
+        nxt_string("undefined_"),
+        nxt_string("functions"),
+        nxt_string("encodeURIComponents"),
+    };
+
+    nxt_memzero(&lexer, sizeof(njs_lexer_t));
+
+    keyword = njs_lexer_keywords(&n);
+
+    for (i = 0; i < n; i++) {
+        lexer.text = keyword[i].name;
+        lexer.key_hash = nxt_djb_hash(lexer.text.start, lexer.text.length);
+
+        token = njs_lexer_keyword(&lexer);
+
+        if (token != keyword[i].token) {
+            printf("keyword \"%.*s\" is not recognized\n",
+                   (int) lexer.text.length, lexer.text.start);
+            return NXT_ERROR;
+        }
+    }
+
+    for (i = 0; i < nxt_nitems(names); i++) {
+        lexer.text = names[i];
+        lexer.key_hash = nxt_djb_hash(lexer.text.start, lexer.text.length);
+
+        token = njs_lexer_keyword(&lexer);
+
+        if (token != NJS_TOKEN_NAME) {
+            printf("name \"%.*s\" is recognized as keyword\n",
+                   (int) lexer.text.length, lexer.text.start);
+            return NXT_ERROR;
+        }
+    }
+
+    return NXT_OK;
+}
+
+
 typedef struct {
     nxt_int_t  (*test)(njs_vm_t *, nxt_bool_t, nxt_bool_t);
     nxt_str_t  name;
@@ -10449,17 +10932,26 @@ njs_api_test(nxt_bool_t disassemble, nxt_bool_t verbose)
     static njs_api_test_t  njs_api_test[] =
     {
         { njs_vm_object_alloc_test,
-          nxt_string("njs_vm_object_alloc_test") }
+          nxt_string("njs_vm_object_alloc_test") },
+        { njs_vm_clone_mem_test,
+          nxt_string("njs_vm_clone_mem_test") },
+        { njs_vm_external_string_test,
+          nxt_string("njs_vm_external_string_test") },
+        { njs_vm_compile_once_test,
+          nxt_string("njs_vm_compile_once_test") },
+        { njs_lexer_keyword_test,
+          nxt_string("njs_lexer_keyword_test") }
     };
 
     rc = NXT_ERROR;
 
     vm = NULL;
-    nxt_memzero(&options, sizeof(njs_vm_opt_t));
 
     for (i = 0; i < nxt_nitems(njs_api_test); i++) {
         test = &njs_api_test[i];
 
+        nxt_memzero(&options, sizeof(njs_vm_opt_t));
+
         vm = njs_vm_create(&options);
         if (vm == NULL) {
             printf("njs_vm_create() failed\n");
@@ -10472,6 +10964,9 @@ njs_api_test(nxt_bool_t disassemble, nxt_bool_t verbose)
                    (int) test->name.length, test->name.start);
             goto done;
         }
+
+        njs_vm_destroy(vm);
+        vm = NULL;
     }
 
     rc = NXT_OK;
@@ -10518,13 +11013,22 @@ main(int argc, char **argv)
     (void) putenv((char *) "TZ=UTC");
     tzset();
 
-    ret = njs_unit_test(njs_test, nxt_nitems(njs_test), disassemble, verbose);
+    ret = njs_unit_test(njs_test, nxt_nitems(njs_test), 0, disassemble,
+                        verbose);
     if (ret != NXT_OK) {
         return ret;
     }
 
     printf("njs unit tests passed\n");
 
+    ret = njs_unit_test(njs_test, nxt_nitems(njs_test), 1, disassemble,
+                        verbose);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    printf("njs arena unit tests passed\n");
+
     /*
      * Chatham Islands NZ-CHAT time zone.
      * Standard time: UTC+12:45, Daylight Saving time: UTC+13:45.
@@ -10538,8 +11042,8 @@ main(int argc, char **argv)
     size = strftime((char *) buf, sizeof(buf), "%z", &tm);
 
     if (memcmp(buf, "+1245", size) == 0) {
-        ret = njs_unit_test(njs_tz_test, nxt_nitems(njs_tz_test), disassemble,
-                            verbose);
+        ret = njs_unit_test(njs_tz_test, nxt_nitems(njs_tz_test), 0,
+                            disassemble, verbose);
         if (ret != NXT_OK) {
             return ret;
         }
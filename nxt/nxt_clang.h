@@ -24,6 +24,11 @@
 #define nxt_nitems(x)                                                         \
     (sizeof(x) / sizeof((x)[0]))
 
+/* A file scope check which breaks compilation if the condition is false. */
+
+#define nxt_static_assert(name, cond)                                         \
+    typedef char nxt_static_assert_##name[(cond) ? 1 : -1]
+
 
 
 #if (NXT_HAVE_BUILTIN_EXPECT)
@@ -86,6 +91,33 @@ nxt_leading_zeros(uint32_t x)
 #endif
 
 
+#if (NXT_HAVE_BUILTIN_CTZ)
+#define nxt_trailing_zeros(x)  (((x) == 0) ? 32 : __builtin_ctz(x))
+
+#else
+
+nxt_inline uint32_t
+nxt_trailing_zeros(uint32_t x)
+{
+    uint32_t  n;
+
+    if (x == 0) {
+        return 32;
+    }
+
+    n = 0;
+
+    while ((x & 1) == 0) {
+        n++;
+        x >>= 1;
+    }
+
+    return n;
+}
+
+#endif
+
+
 #if (NXT_HAVE_BUILTIN_CLZLL)
 #define nxt_leading_zeros64(x)  (((x) == 0) ? 64 : __builtin_clzll(x))
 
@@ -134,6 +166,22 @@ nxt_leading_zeros64(uint64_t x)
 #endif
 
 
+/*
+ * Per-thread data makes the library thread-safe.  Without thread local
+ * storage the data are process-wide and the thread-safe mode is disabled:
+ * VMs must not be used in different threads concurrently.
+ */
+
+#if (NXT_HAVE_GCC_THREAD_LOCAL)
+#define nxt_thread_local   __thread
+#define NXT_THREADS        1
+
+#else
+#define nxt_thread_local
+#define NXT_THREADS        0
+#endif
+
+
 #if (NXT_HAVE_GCC_ATTRIBUTE_MALLOC)
 #define NXT_MALLOC_LIKE    __attribute__((__malloc__))
 
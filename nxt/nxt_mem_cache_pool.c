@@ -11,7 +11,6 @@
 #include <nxt_stub.h>
 #include <nxt_string.h>
 #include <nxt_queue.h>
-#include <nxt_rbtree.h>
 #include <nxt_mem_cache_pool.h>
 #include <string.h>
 
@@ -24,9 +23,23 @@
  * A cluster can contains pages with different chunk sizes.  Cluster size
  * must be a multiple of page size and may be not a power of 2.  Allocations
  * greater than page are allocated outside clusters.  Start addresses and
- * sizes of the clusters and large allocations are stored in rbtree blocks
- * to find them on free operations.  The rbtree nodes are sorted by start
- * addresses.
+ * sizes of the clusters and large allocations are stored in blocks which
+ * are linked in a page map to find them on free operations in constant
+ * time.  A cluster is aligned to its size rounded up to a power of 2, so
+ * the cluster start address is found by masking any address inside it.
+ * The page map is a hash of the blocks by their start addresses shifted
+ * by the cluster size.
+ *
+ * Clusters and pools released in a thread are kept in a small per-thread
+ * magazine and are reused by pools of the same geometry and allocator
+ * without context created in the thread later, so in steady state
+ * creation and destruction of short-lived pools do not touch the
+ * underlying allocator.
+ *
+ * An arena pool does not use clusters at all.  Allocations are bumped
+ * from regions of specified size, free operation is a no-op, and all
+ * regions are released at once when the pool is destroyed.  This suits
+ * short-lived pools which free little memory during their lifetime.
  */
 
 
@@ -75,8 +88,12 @@ typedef enum {
 } nxt_mem_cache_block_type_t;
 
 
-typedef struct {
-    NXT_RBTREE_NODE             (node);
+typedef struct nxt_mem_cache_block_s  nxt_mem_cache_block_t;
+
+struct nxt_mem_cache_block_s {
+    /* Next block in the same page map bucket. */
+    nxt_mem_cache_block_t       *next;
+
     nxt_mem_cache_block_type_t  type:8;
 
     /* Block size must be less than 4G. */
@@ -84,7 +101,14 @@ typedef struct {
 
     u_char                      *start;
     nxt_mem_cache_page_t        pages[];
-} nxt_mem_cache_block_t;
+};
+
+
+typedef struct nxt_mem_cache_region_s  nxt_mem_cache_region_t;
+
+struct nxt_mem_cache_region_s {
+    nxt_mem_cache_region_t      *next;
+};
 
 
 typedef struct {
@@ -103,17 +127,27 @@ typedef struct {
 
 
 struct nxt_mem_cache_pool_s {
-    /* rbtree of nxt_mem_cache_block_t. */
-    nxt_rbtree_t                blocks;
+    /* Page map of nxt_mem_cache_block_t. */
+    nxt_mem_cache_block_t       **map;
+    uint32_t                    map_mask;
+    uint32_t                    blocks;
 
     nxt_queue_t                 free_pages;
 
     uint8_t                     chunk_size_shift;
     uint8_t                     page_size_shift;
+    uint8_t                     cluster_shift;
     uint32_t                    page_size;
     uint32_t                    page_alignment;
     uint32_t                    cluster_size;
 
+    /* A list of arena regions. */
+    nxt_mem_cache_region_t      *regions;
+    u_char                      *arena_free;
+    u_char                      *arena_end;
+    /* Arena region size, zero for cluster pools. */
+    uint32_t                    region_size;
+
     const nxt_mem_proto_t       *proto;
     void                        *mem;
     void                        *trace;
@@ -138,6 +172,45 @@ struct nxt_mem_cache_pool_s {
     ((((value) - 1) & (value)) == 0)
 
 
+#define NXT_MEM_CACHE_MAP_SIZE  16
+
+
+#if (NXT_HAVE_GCC_THREAD_LOCAL && !NXT_DEBUG_MEMORY)
+
+#define NXT_MEM_CACHE_MAGAZINE       1
+#define NXT_MEM_CACHE_MAGAZINE_SIZE  16
+
+typedef struct {
+    /* The allocator and geometry of the cached clusters and pools. */
+    const nxt_mem_proto_t       *proto;
+    void                        *mem;
+    uint32_t                    cluster_size;
+    uint32_t                    page_size;
+    uint8_t                     chunk_size_shift;
+
+    uint8_t                     nclusters;
+    uint8_t                     npools;
+
+    /* A list of free clusters linked by nxt_mem_cache_block_t.next. */
+    nxt_mem_cache_block_t       *clusters;
+    nxt_mem_cache_pool_t        *pools[NXT_MEM_CACHE_MAGAZINE_SIZE];
+} nxt_mem_cache_magazine_t;
+
+
+static nxt_thread_local nxt_mem_cache_magazine_t  nxt_mem_cache_magazine;
+
+#else
+
+#define NXT_MEM_CACHE_MAGAZINE       0
+
+#endif
+
+
+#define nxt_mem_cache_map_bucket(pool, p)                                     \
+    (&(pool)->map[((uintptr_t) (p) >> (pool)->cluster_shift)                  \
+                  & (pool)->map_mask])
+
+
 static nxt_uint_t nxt_mem_cache_shift(nxt_uint_t n);
 #if !(NXT_DEBUG_MEMORY)
 static void *nxt_mem_cache_alloc_small(nxt_mem_cache_pool_t *pool, size_t size);
@@ -149,12 +222,23 @@ static nxt_mem_cache_block_t *
 #endif
 static void *nxt_mem_cache_alloc_large(nxt_mem_cache_pool_t *pool,
     size_t alignment, size_t size);
-static intptr_t nxt_mem_cache_rbtree_compare(nxt_rbtree_node_t *node1,
-    nxt_rbtree_node_t *node2);
-static nxt_mem_cache_block_t *nxt_mem_cache_find_block(nxt_rbtree_t *tree,
-    u_char *p);
+static void *nxt_mem_cache_arena_alloc(nxt_mem_cache_pool_t *pool,
+    size_t alignment, size_t size);
+static nxt_int_t nxt_mem_cache_map_insert(nxt_mem_cache_pool_t *pool,
+    nxt_mem_cache_block_t *block);
+static void nxt_mem_cache_map_delete(nxt_mem_cache_pool_t *pool,
+    nxt_mem_cache_block_t *block);
+static nxt_mem_cache_block_t *nxt_mem_cache_map_find(
+    nxt_mem_cache_pool_t *pool, u_char *start);
 static const char *nxt_mem_cache_chunk_free(nxt_mem_cache_pool_t *pool,
     nxt_mem_cache_block_t *cluster, u_char *p);
+static void nxt_mem_cache_free_cluster(nxt_mem_cache_pool_t *pool,
+    nxt_mem_cache_block_t *cluster);
+#if (NXT_MEM_CACHE_MAGAZINE)
+static nxt_mem_cache_magazine_t *nxt_mem_cache_magazine_get(
+    const nxt_mem_proto_t *proto, void *mem, size_t cluster_size,
+    size_t page_size, nxt_uint_t chunk_size_shift);
+#endif
 
 
 nxt_mem_cache_pool_t *
@@ -195,9 +279,14 @@ nxt_mem_cache_pool_fast_create(const nxt_mem_proto_t *proto, void *mem,
     void *trace, size_t cluster_size, size_t page_alignment, size_t page_size,
     size_t min_chunk_size)
 {
-    nxt_uint_t            slots, chunk_size;
-    nxt_mem_cache_slot_t  *slot;
-    nxt_mem_cache_pool_t  *pool;
+    size_t                    size;
+    nxt_uint_t                slots, chunk_size;
+    nxt_mem_cache_slot_t      *slot;
+    nxt_mem_cache_pool_t      *pool;
+#if (NXT_MEM_CACHE_MAGAZINE)
+    nxt_mem_cache_block_t     **map;
+    nxt_mem_cache_magazine_t  *magazine;
+#endif
 
     slots = 0;
     chunk_size = page_size;
@@ -207,8 +296,37 @@ nxt_mem_cache_pool_fast_create(const nxt_mem_proto_t *proto, void *mem,
         chunk_size /= 2;
     } while (chunk_size > min_chunk_size);
 
-    pool = proto->zalloc(mem, sizeof(nxt_mem_cache_pool_t)
-                              + slots * sizeof(nxt_mem_cache_slot_t));
+    size = sizeof(nxt_mem_cache_pool_t) + slots * sizeof(nxt_mem_cache_slot_t);
+
+#if (NXT_MEM_CACHE_MAGAZINE)
+
+    magazine = nxt_mem_cache_magazine_get(proto, mem, cluster_size, page_size,
+                                          nxt_mem_cache_shift(min_chunk_size));
+
+    if (magazine != NULL && magazine->npools != 0) {
+        pool = magazine->pools[--magazine->npools];
+
+        /* The page map of a cached pool is kept at its initial size. */
+        map = pool->map;
+
+        nxt_memzero(pool, size);
+
+        if (map != NULL) {
+            nxt_memzero(map, NXT_MEM_CACHE_MAP_SIZE
+                             * sizeof(nxt_mem_cache_block_t *));
+            pool->map = map;
+            pool->map_mask = NXT_MEM_CACHE_MAP_SIZE - 1;
+        }
+
+    } else {
+        pool = proto->zalloc(mem, size);
+    }
+
+#else
+
+    pool = proto->zalloc(mem, size);
+
+#endif
 
     if (nxt_fast_path(pool != NULL)) {
         pool->proto = proto;
@@ -234,8 +352,38 @@ nxt_mem_cache_pool_fast_create(const nxt_mem_proto_t *proto, void *mem,
 
         pool->chunk_size_shift = nxt_mem_cache_shift(min_chunk_size);
         pool->page_size_shift = nxt_mem_cache_shift(page_size);
+        pool->cluster_shift = nxt_mem_cache_shift(cluster_size);
 
-        nxt_rbtree_init(&pool->blocks, nxt_mem_cache_rbtree_compare);
+        if (((size_t) 1 << pool->cluster_shift) < cluster_size) {
+            pool->cluster_shift++;
+        }
+
+        nxt_queue_init(&pool->free_pages);
+    }
+
+    return pool;
+}
+
+
+nxt_mem_cache_pool_t *
+nxt_mem_cache_pool_arena_create(const nxt_mem_proto_t *proto, void *mem,
+    void *trace, size_t region_size)
+{
+    nxt_mem_cache_pool_t  *pool;
+
+    if (nxt_slow_path(region_size < 1024 || region_size >= 0xffffffff)) {
+        return NULL;
+    }
+
+    pool = proto->zalloc(mem, sizeof(nxt_mem_cache_pool_t));
+
+    if (nxt_fast_path(pool != NULL)) {
+        pool->proto = proto;
+        pool->mem = mem;
+        pool->trace = trace;
+
+        pool->page_alignment = NXT_MAX_ALIGNMENT;
+        pool->region_size = region_size;
 
         nxt_queue_init(&pool->free_pages);
     }
@@ -264,7 +412,8 @@ nxt_mem_cache_shift(nxt_uint_t n)
 nxt_bool_t
 nxt_mem_cache_pool_is_empty(nxt_mem_cache_pool_t *pool)
 {
-    return (nxt_rbtree_is_empty(&pool->blocks)
+    return (pool->regions == NULL
+            && pool->blocks == 0
             && nxt_queue_is_empty(&pool->free_pages));
 }
 
@@ -272,30 +421,112 @@ nxt_mem_cache_pool_is_empty(nxt_mem_cache_pool_t *pool)
 void
 nxt_mem_cache_pool_destroy(nxt_mem_cache_pool_t *pool)
 {
-    void                   *p;
-    nxt_rbtree_node_t      *node, *next;
-    nxt_mem_cache_block_t  *block;
+    void                      *p;
+    uint32_t                  i;
+    nxt_mem_cache_block_t     *block, *next;
+    nxt_mem_cache_region_t    *region;
+#if (NXT_MEM_CACHE_MAGAZINE)
+    nxt_mem_cache_magazine_t  *magazine;
+#endif
 
-    next = nxt_rbtree_root(&pool->blocks);
+    while (pool->regions != NULL) {
+        region = pool->regions;
+        pool->regions = region->next;
 
-    while (next != nxt_rbtree_sentinel(&pool->blocks)) {
+        pool->proto->free(pool->mem, region);
+    }
 
-        node = nxt_rbtree_destroy_next(&pool->blocks, &next);
-        block = (nxt_mem_cache_block_t *) node;
+    if (pool->map != NULL) {
 
-        p = block->start;
+        for (i = 0; i <= pool->map_mask; i++) {
 
-        if (block->type != NXT_MEM_CACHE_EMBEDDED_BLOCK) {
-            pool->proto->free(pool->mem, block);
+            for (block = pool->map[i]; block != NULL; block = next) {
+                next = block->next;
+
+                if (block->type == NXT_MEM_CACHE_CLUSTER_BLOCK) {
+                    nxt_mem_cache_free_cluster(pool, block);
+                    continue;
+                }
+
+                p = block->start;
+
+                if (block->type != NXT_MEM_CACHE_EMBEDDED_BLOCK) {
+                    pool->proto->free(pool->mem, block);
+                }
+
+                pool->proto->free(pool->mem, p);
+            }
+        }
+    }
+
+#if (NXT_MEM_CACHE_MAGAZINE)
+
+    if (pool->region_size == 0) {
+        magazine = nxt_mem_cache_magazine_get(pool->proto, pool->mem,
+                                              pool->cluster_size,
+                                              pool->page_size,
+                                              pool->chunk_size_shift);
+
+        if (magazine != NULL
+            && magazine->npools < NXT_MEM_CACHE_MAGAZINE_SIZE
+            && (pool->map == NULL
+                || pool->map_mask == NXT_MEM_CACHE_MAP_SIZE - 1))
+        {
+            magazine->pools[magazine->npools++] = pool;
+            return;
         }
+    }
 
-        pool->proto->free(pool->mem, p);
+#endif
+
+    if (pool->map != NULL) {
+        pool->proto->free(pool->mem, pool->map);
     }
 
     pool->proto->free(pool->mem, pool);
 }
 
 
+/*
+ * The function releases clusters and pools cached by the current thread.
+ * It should be called before a thread exits.
+ */
+
+void
+nxt_mem_cache_pool_thread_cache_flush(void)
+{
+#if (NXT_MEM_CACHE_MAGAZINE)
+
+    nxt_mem_cache_pool_t      *pool;
+    nxt_mem_cache_block_t     *cluster;
+    nxt_mem_cache_magazine_t  *magazine;
+
+    magazine = &nxt_mem_cache_magazine;
+
+    while (magazine->clusters != NULL) {
+        cluster = magazine->clusters;
+        magazine->clusters = cluster->next;
+
+        magazine->proto->free(magazine->mem, cluster->start);
+        magazine->proto->free(magazine->mem, cluster);
+    }
+
+    while (magazine->npools != 0) {
+        pool = magazine->pools[--magazine->npools];
+
+        if (pool->map != NULL) {
+            magazine->proto->free(magazine->mem, pool->map);
+        }
+
+        magazine->proto->free(magazine->mem, pool);
+    }
+
+    magazine->nclusters = 0;
+
+#endif
+}
+
+
 void *
 nxt_mem_cache_alloc(nxt_mem_cache_pool_t *pool, size_t size)
 {
@@ -303,6 +534,10 @@ nxt_mem_cache_alloc(nxt_mem_cache_pool_t *pool, size_t size)
         pool->proto->trace(pool->trace, "mem cache alloc: %zd", size);
     }
 
+    if (pool->region_size != 0) {
+        return nxt_mem_cache_arena_alloc(pool, NXT_MAX_ALIGNMENT, size);
+    }
+
 #if !(NXT_DEBUG_MEMORY)
 
     if (size <= pool->page_size) {
@@ -342,6 +577,10 @@ nxt_mem_cache_align(nxt_mem_cache_pool_t *pool, size_t alignment, size_t size)
 
     if (nxt_fast_path(nxt_is_power_of_two(alignment))) {
 
+        if (pool->region_size != 0) {
+            return nxt_mem_cache_arena_alloc(pool, alignment, size);
+        }
+
 #if !(NXT_DEBUG_MEMORY)
 
         if (size <= pool->page_size && alignment <= pool->page_alignment) {
@@ -534,11 +773,32 @@ nxt_mem_cache_alloc_page(nxt_mem_cache_pool_t *pool)
 static nxt_mem_cache_block_t *
 nxt_mem_cache_alloc_cluster(nxt_mem_cache_pool_t *pool)
 {
-    nxt_uint_t             n;
-    nxt_mem_cache_block_t  *cluster;
+    nxt_uint_t                n;
+    nxt_mem_cache_block_t     *cluster;
+#if (NXT_MEM_CACHE_MAGAZINE)
+    nxt_mem_cache_magazine_t  *magazine;
+#endif
 
     n = pool->cluster_size >> pool->page_size_shift;
 
+#if (NXT_MEM_CACHE_MAGAZINE)
+
+    magazine = nxt_mem_cache_magazine_get(pool->proto, pool->mem,
+                                          pool->cluster_size, pool->page_size,
+                                          pool->chunk_size_shift);
+
+    if (magazine != NULL && magazine->clusters != NULL) {
+        cluster = magazine->clusters;
+        magazine->clusters = cluster->next;
+        magazine->nclusters--;
+
+        nxt_memzero(cluster->pages, n * sizeof(nxt_mem_cache_page_t));
+
+        goto insert;
+    }
+
+#endif
+
     cluster = pool->proto->zalloc(pool->mem, sizeof(nxt_mem_cache_block_t)
                                            + n * sizeof(nxt_mem_cache_page_t));
 
@@ -550,13 +810,24 @@ nxt_mem_cache_alloc_cluster(nxt_mem_cache_pool_t *pool)
 
     cluster->size = pool->cluster_size;
 
-    cluster->start = pool->proto->align(pool->mem, pool->page_alignment,
+    cluster->start = pool->proto->align(pool->mem,
+                                        (size_t) 1 << pool->cluster_shift,
                                         pool->cluster_size);
     if (nxt_slow_path(cluster->start == NULL)) {
         pool->proto->free(pool->mem, cluster);
         return NULL;
     }
 
+#if (NXT_MEM_CACHE_MAGAZINE)
+insert:
+#endif
+
+    if (nxt_slow_path(nxt_mem_cache_map_insert(pool, cluster) != NXT_OK)) {
+        pool->proto->free(pool->mem, cluster->start);
+        pool->proto->free(pool->mem, cluster);
+        return NULL;
+    }
+
     n--;
     cluster->pages[n].number = n;
     nxt_queue_insert_head(&pool->free_pages, &cluster->pages[n].link);
@@ -568,8 +839,6 @@ nxt_mem_cache_alloc_cluster(nxt_mem_cache_pool_t *pool)
                                 &cluster->pages[n].link);
     }
 
-    nxt_rbtree_insert(&pool->blocks, &cluster->node);
-
     return cluster;
 }
 
@@ -622,95 +891,234 @@ nxt_mem_cache_alloc_large(nxt_mem_cache_pool_t *pool, size_t alignment,
     block->size = size;
     block->start = p;
 
-    nxt_rbtree_insert(&pool->blocks, &block->node);
+    if (nxt_slow_path(nxt_mem_cache_map_insert(pool, block) != NXT_OK)) {
+        if (type == NXT_MEM_CACHE_DISCRETE_BLOCK) {
+            pool->proto->free(pool->mem, block);
+        }
+
+        pool->proto->free(pool->mem, p);
+
+        return NULL;
+    }
 
     return p;
 }
 
 
-static intptr_t
-nxt_mem_cache_rbtree_compare(nxt_rbtree_node_t *node1, nxt_rbtree_node_t *node2)
+static nxt_int_t
+nxt_mem_cache_map_insert(nxt_mem_cache_pool_t *pool,
+    nxt_mem_cache_block_t *block)
 {
-    nxt_mem_cache_block_t  *block1, *block2;
+    uint32_t               i, size;
+    nxt_mem_cache_block_t  **map, **bucket, *next;
+
+    if (pool->map == NULL || pool->blocks > pool->map_mask) {
+        /* The map grows twice to keep about one block per bucket. */
+
+        size = (pool->map != NULL) ? 2 * (pool->map_mask + 1)
+                                   : NXT_MEM_CACHE_MAP_SIZE;
 
-    block1 = (nxt_mem_cache_block_t *) node1;
-    block2 = (nxt_mem_cache_block_t *) node2;
+        map = pool->proto->zalloc(pool->mem,
+                                  size * sizeof(nxt_mem_cache_block_t *));
+        if (nxt_slow_path(map == NULL)) {
+            return NXT_ERROR;
+        }
+
+        if (pool->map != NULL) {
+
+            for (i = 0; i <= pool->map_mask; i++) {
+
+                while (pool->map[i] != NULL) {
+                    next = pool->map[i];
+                    pool->map[i] = next->next;
+
+                    bucket = &map[((uintptr_t) next->start
+                                   >> pool->cluster_shift) & (size - 1)];
+                    next->next = *bucket;
+                    *bucket = next;
+                }
+            }
+
+            pool->proto->free(pool->mem, pool->map);
+        }
 
-    return (uintptr_t) block1->start - (uintptr_t) block2->start;
+        pool->map = map;
+        pool->map_mask = size - 1;
+    }
+
+    bucket = nxt_mem_cache_map_bucket(pool, block->start);
+
+    block->next = *bucket;
+    *bucket = block;
+
+    pool->blocks++;
+
+    return NXT_OK;
 }
 
 
-void
-nxt_mem_cache_free(nxt_mem_cache_pool_t *pool, void *p)
+static void
+nxt_mem_cache_map_delete(nxt_mem_cache_pool_t *pool,
+    nxt_mem_cache_block_t *block)
+{
+    nxt_mem_cache_block_t  **bucket;
+
+    bucket = nxt_mem_cache_map_bucket(pool, block->start);
+
+    while (*bucket != block) {
+        bucket = &(*bucket)->next;
+    }
+
+    *bucket = block->next;
+
+    pool->blocks--;
+}
+
+
+static nxt_mem_cache_block_t *
+nxt_mem_cache_map_find(nxt_mem_cache_pool_t *pool, u_char *start)
 {
-    const char             *err;
     nxt_mem_cache_block_t  *block;
 
-    if (pool->proto->trace != NULL) {
-        pool->proto->trace(pool->trace, "mem cache free %p", p);
+    if (nxt_slow_path(pool->map == NULL)) {
+        return NULL;
     }
 
-    block = nxt_mem_cache_find_block(&pool->blocks, p);
+    block = *nxt_mem_cache_map_bucket(pool, start);
 
-    if (nxt_fast_path(block != NULL)) {
+    while (block != NULL) {
 
-        if (block->type == NXT_MEM_CACHE_CLUSTER_BLOCK) {
-            err = nxt_mem_cache_chunk_free(pool, block, p);
+        if (block->start == start) {
+            return block;
+        }
 
-            if (nxt_fast_path(err == NULL)) {
-                return;
-            }
+        block = block->next;
+    }
 
-        } else if (nxt_fast_path(p == block->start)) {
-            nxt_rbtree_delete(&pool->blocks, &block->node);
+    return NULL;
+}
 
-            if (block->type == NXT_MEM_CACHE_DISCRETE_BLOCK) {
-                pool->proto->free(pool->mem, block);
-            }
 
-            pool->proto->free(pool->mem, p);
+static void *
+nxt_mem_cache_arena_alloc(nxt_mem_cache_pool_t *pool, size_t alignment,
+    size_t size)
+{
+    u_char                  *p;
+    size_t                  header;
+    nxt_mem_cache_region_t  *region;
 
-            return;
+    alignment = nxt_max(alignment, NXT_MAX_ALIGNMENT);
+
+    p = nxt_align_ptr(pool->arena_free, alignment);
+
+    if (nxt_fast_path(pool->arena_free != NULL
+                      && p <= pool->arena_end
+                      && size <= (size_t) (pool->arena_end - p)))
+    {
+        pool->arena_free = p + size;
+        return p;
+    }
+
+    /* Allocation must be less than 4G. */
+    if (nxt_slow_path(size >= 0xffffffff)) {
+        return NULL;
+    }
+
+    header = nxt_align_size(sizeof(nxt_mem_cache_region_t), alignment);
+
+    if (size > pool->region_size / 4 || alignment > pool->region_size / 4) {
+        /*
+         * A large allocation is placed in a dedicated region
+         * to keep the rest of the current region available.
+         */
+        region = pool->proto->align(pool->mem, alignment, header + size);
+        if (nxt_slow_path(region == NULL)) {
+            return NULL;
+        }
+
+        if (pool->regions != NULL) {
+            region->next = pool->regions->next;
+            pool->regions->next = region;
 
         } else {
-            err = "freed pointer points to middle of block: %p";
+            region->next = NULL;
+            pool->regions = region;
         }
 
-    } else {
-        err = "freed pointer is out of pool: %p";
+        return (u_char *) region + header;
     }
 
-    if (pool->proto->alert != NULL) {
-        pool->proto->alert(pool->trace, err, p);
+    region = pool->proto->align(pool->mem, pool->page_alignment,
+                                pool->region_size);
+    if (nxt_slow_path(region == NULL)) {
+        return NULL;
     }
+
+    region->next = pool->regions;
+    pool->regions = region;
+
+    p = nxt_align_ptr((u_char *) region + sizeof(nxt_mem_cache_region_t),
+                      alignment);
+
+    pool->arena_free = p + size;
+    pool->arena_end = (u_char *) region + pool->region_size;
+
+    return p;
 }
 
 
-static nxt_mem_cache_block_t *
-nxt_mem_cache_find_block(nxt_rbtree_t *tree, u_char *p)
+void
+nxt_mem_cache_free(nxt_mem_cache_pool_t *pool, void *p)
 {
-    nxt_rbtree_node_t      *node, *sentinel;
+    u_char                 *start;
+    const char             *err;
     nxt_mem_cache_block_t  *block;
 
-    node = nxt_rbtree_root(tree);
-    sentinel = nxt_rbtree_sentinel(tree);
+    if (pool->proto->trace != NULL) {
+        pool->proto->trace(pool->trace, "mem cache free %p", p);
+    }
+
+    if (pool->region_size != 0) {
+        /* Arena memory is released only by pool destruction. */
+        return;
+    }
+
+    /* A cluster start address is found by masking the freed pointer. */
 
-    while (node != sentinel) {
+    start = nxt_trunc_ptr(p, (size_t) 1 << pool->cluster_shift);
+    block = nxt_mem_cache_map_find(pool, start);
 
-        block = (nxt_mem_cache_block_t *) node;
+    if (nxt_fast_path(block != NULL
+                      && block->type == NXT_MEM_CACHE_CLUSTER_BLOCK
+                      && (u_char *) p < block->start + block->size))
+    {
+        err = nxt_mem_cache_chunk_free(pool, block, p);
 
-        if (p < block->start) {
-            node = node->left;
+        if (nxt_fast_path(err == NULL)) {
+            return;
+        }
 
-        } else if (p >= block->start + block->size) {
-            node = node->right;
+    } else {
+        block = nxt_mem_cache_map_find(pool, p);
 
-        } else {
-            return block;
+        if (nxt_fast_path(block != NULL)) {
+            nxt_mem_cache_map_delete(pool, block);
+
+            if (block->type == NXT_MEM_CACHE_DISCRETE_BLOCK) {
+                pool->proto->free(pool->mem, block);
+            }
+
+            pool->proto->free(pool->mem, p);
+
+            return;
         }
+
+        err = "freed pointer is out of pool: %p";
     }
 
-    return NULL;
+    if (pool->proto->alert != NULL) {
+        pool->proto->alert(pool->trace, err, p);
+    }
 }
 
 
@@ -812,12 +1220,83 @@ nxt_mem_cache_chunk_free(nxt_mem_cache_pool_t *pool,
          n--;
     } while (n != 0);
 
-    nxt_rbtree_delete(&pool->blocks, &cluster->node);
+    nxt_mem_cache_map_delete(pool, cluster);
+
+    nxt_mem_cache_free_cluster(pool, cluster);
+
+    return NULL;
+}
+
+
+static void
+nxt_mem_cache_free_cluster(nxt_mem_cache_pool_t *pool,
+    nxt_mem_cache_block_t *cluster)
+{
+    u_char                    *p;
+#if (NXT_MEM_CACHE_MAGAZINE)
+    nxt_mem_cache_magazine_t  *magazine;
+
+    magazine = nxt_mem_cache_magazine_get(pool->proto, pool->mem,
+                                          pool->cluster_size, pool->page_size,
+                                          pool->chunk_size_shift);
+
+    if (magazine != NULL && magazine->nclusters < NXT_MEM_CACHE_MAGAZINE_SIZE) {
+        cluster->next = magazine->clusters;
+        magazine->clusters = cluster;
+        magazine->nclusters++;
+        return;
+    }
+
+#endif
 
     p = cluster->start;
 
     pool->proto->free(pool->mem, cluster);
     pool->proto->free(pool->mem, p);
+}
+
+
+#if (NXT_MEM_CACHE_MAGAZINE)
+
+/*
+ * The magazine is bound to an allocator and a pool geometry while it
+ * caches anything and is rebound to another one once it becomes empty.
+ * Memory of allocators with a context is not cached, since the context
+ * may release the memory on its own, e.g. nginx request pool.
+ */
+
+static nxt_mem_cache_magazine_t *
+nxt_mem_cache_magazine_get(const nxt_mem_proto_t *proto, void *mem,
+    size_t cluster_size, size_t page_size, nxt_uint_t chunk_size_shift)
+{
+    nxt_mem_cache_magazine_t  *magazine;
+
+    if (mem != NULL) {
+        return NULL;
+    }
+
+    magazine = &nxt_mem_cache_magazine;
+
+    if (nxt_fast_path(magazine->proto == proto
+                      && magazine->mem == mem
+                      && magazine->cluster_size == cluster_size
+                      && magazine->page_size == page_size
+                      && magazine->chunk_size_shift == chunk_size_shift))
+    {
+        return magazine;
+    }
+
+    if (magazine->nclusters == 0 && magazine->npools == 0) {
+        magazine->proto = proto;
+        magazine->mem = mem;
+        magazine->cluster_size = cluster_size;
+        magazine->page_size = page_size;
+        magazine->chunk_size_shift = chunk_size_shift;
+
+        return magazine;
+    }
 
     return NULL;
 }
+
+#endif
@@ -21,8 +21,13 @@ NXT_EXPORT nxt_mem_cache_pool_t *
     void *trace, size_t cluster_size, size_t page_alignment, size_t page_size,
     size_t min_chunk_size)
     NXT_MALLOC_LIKE;
+NXT_EXPORT nxt_mem_cache_pool_t *
+    nxt_mem_cache_pool_arena_create(const nxt_mem_proto_t *proto, void *mem,
+    void *trace, size_t region_size)
+    NXT_MALLOC_LIKE;
 NXT_EXPORT nxt_bool_t nxt_mem_cache_pool_is_empty(nxt_mem_cache_pool_t *pool);
 NXT_EXPORT void nxt_mem_cache_pool_destroy(nxt_mem_cache_pool_t *pool);
+NXT_EXPORT void nxt_mem_cache_pool_thread_cache_flush(void);
 
 NXT_EXPORT void *nxt_mem_cache_alloc(nxt_mem_cache_pool_t *pool, size_t size)
     NXT_MALLOC_LIKE;
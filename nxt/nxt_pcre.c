@@ -12,15 +12,34 @@
 #include <nxt_regex.h>
 #include <nxt_pcre.h>
 #include <string.h>
+#if (NXT_HAVE_PTHREAD)
+#include <pthread.h>
+#endif
 
 
+static void nxt_pcre_hooks_install(void);
 static void *nxt_pcre_malloc(size_t size);
 static void nxt_pcre_free(void *p);
 static void *nxt_pcre_default_malloc(size_t size, void *memory_data);
 static void nxt_pcre_default_free(void *p, void *memory_data);
 
 
-static nxt_regex_context_t  *regex_context;
+/*
+ * PCRE allocation hooks are global, so they are installed once by
+ * pthread_once() and route allocations of a thread compiling a regular
+ * expression to its current context and all other allocations to the
+ * original allocator.  This allows to compile regular expressions in
+ * cloned VMs running in different threads.
+ */
+
+static nxt_thread_local nxt_regex_context_t  *regex_context;
+
+static void *(*nxt_pcre_saved_malloc)(size_t size);
+static void (*nxt_pcre_saved_free)(void *p);
+
+#if (NXT_HAVE_PTHREAD)
+static pthread_once_t  nxt_pcre_once = PTHREAD_ONCE_INIT;
+#endif
 
 
 nxt_regex_context_t *
@@ -52,16 +71,19 @@ nxt_regex_compile(nxt_regex_t *regex, u_char *source, size_t len,
 {
     int         ret, err, erroff;
     char        *pattern, *error;
-    void        *(*saved_malloc)(size_t size);
-    void        (*saved_free)(void *p);
     const char  *errstr;
 
     ret = NXT_ERROR;
 
-    saved_malloc = pcre_malloc;
-    pcre_malloc = nxt_pcre_malloc;
-    saved_free = pcre_free;
-    pcre_free = nxt_pcre_free;
+#if (NXT_HAVE_PTHREAD)
+    (void) pthread_once(&nxt_pcre_once, nxt_pcre_hooks_install);
+
+#else
+    if (pcre_malloc != nxt_pcre_malloc) {
+        nxt_pcre_hooks_install();
+    }
+#endif
+
     regex_context = ctx;
 
     if (len == 0) {
@@ -122,8 +144,6 @@ nxt_regex_compile(nxt_regex_t *regex, u_char *source, size_t len,
 
 done:
 
-    pcre_malloc = saved_malloc;
-    pcre_free = saved_free;
     regex_context = NULL;
 
     return ret;
@@ -180,17 +200,36 @@ nxt_regex_match_data_free(nxt_regex_match_data_t *match_data,
 }
 
 
+static void
+nxt_pcre_hooks_install(void)
+{
+    nxt_pcre_saved_malloc = pcre_malloc;
+    nxt_pcre_saved_free = pcre_free;
+    pcre_malloc = nxt_pcre_malloc;
+    pcre_free = nxt_pcre_free;
+}
+
+
 static void *
 nxt_pcre_malloc(size_t size)
 {
-    return regex_context->private_malloc(size, regex_context->memory_data);
+    if (regex_context != NULL) {
+        return regex_context->private_malloc(size, regex_context->memory_data);
+    }
+
+    return nxt_pcre_saved_malloc(size);
 }
 
 
 static void
 nxt_pcre_free(void *p)
 {
-    regex_context->private_free(p, regex_context->memory_data);
+    if (regex_context != NULL) {
+        regex_context->private_free(p, regex_context->memory_data);
+        return;
+    }
+
+    nxt_pcre_saved_free(p);
 }
 
 
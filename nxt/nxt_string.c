@@ -0,0 +1,508 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_auto_config.h>
+#include <nxt_types.h>
+#include <nxt_clang.h>
+#include <nxt_string.h>
+#include <nxt_stub.h>
+#include <string.h>
+
+#if (NXT_HAVE_SSE2)
+#include <emmintrin.h>
+
+static const u_char *nxt_memstr_sse2(const u_char **pos, const u_char *last,
+    const u_char *ss, size_t length, nxt_bool_t bounded);
+#endif
+
+static size_t nxt_ascii_case(u_char *dst, const u_char *src, size_t size,
+    u_char first, u_char last);
+
+
+/*
+ * nxt_memstr() and nxt_memrstr() return the first and the last occurrence
+ * of the "ss" string of "length" bytes entirely within [start, end) or
+ * NULL if there is none.  An empty string is found at start and at end
+ * respectively.
+ *
+ * The search tests the first and the last bytes of the string at 16
+ * positions at once and compares the middle bytes only at positions
+ * where both bytes match, so in a typical text most positions are
+ * skipped without comparison.  Without SSE2 candidate positions are
+ * found by memchr().
+ */
+
+const u_char *
+nxt_memstr(const u_char *start, const u_char *end, const u_char *ss,
+    size_t length)
+{
+    u_char        c;
+    const u_char  *p, *last;
+
+    if (length == 0) {
+        return start;
+    }
+
+    if ((size_t) (end - start) < length) {
+        return NULL;
+    }
+
+    if (length == 1) {
+        return memchr(start, ss[0], end - start);
+    }
+
+    p = start;
+
+    /* The last position the string can start at. */
+    last = end - length;
+
+#if (NXT_HAVE_SSE2)
+
+    start = nxt_memstr_sse2(&p, last, ss, length, 0);
+
+    if (start != NULL) {
+        return start;
+    }
+
+#endif
+
+    c = ss[length - 1];
+
+    while (p <= last) {
+        p = memchr(p, ss[0], last - p + 1);
+
+        if (p == NULL) {
+            return NULL;
+        }
+
+        if (p[length - 1] == c && memcmp(p + 1, ss + 1, length - 2) == 0) {
+            return p;
+        }
+
+        p++;
+    }
+
+    return NULL;
+}
+
+
+#if (NXT_HAVE_SSE2)
+
+/*
+ * nxt_memstr_sse2() returns the first occurrence starting at positions
+ * from "*pos" to "last" or NULL.  In the latter case "*pos" is set to
+ * the first position which has not been tested: less than 16 positions
+ * remain or, if the search is bounded, the candidate positions turned out
+ * to be too frequent to compare them all in linear time.
+ */
+
+static const u_char *
+nxt_memstr_sse2(const u_char **pos, const u_char *last, const u_char *ss,
+    size_t length, nxt_bool_t bounded)
+{
+    size_t        candidates;
+    uint32_t      n, mask;
+    __m128i       first, tail, a, b;
+    const u_char  *p, *start;
+
+    p = *pos;
+    start = p;
+    candidates = 0;
+
+    first = _mm_set1_epi8(ss[0]);
+    tail = _mm_set1_epi8(ss[length - 1]);
+
+    while (last - p >= 16) {
+        a = _mm_loadu_si128((const __m128i *) p);
+        b = _mm_loadu_si128((const __m128i *) (p + length - 1));
+
+        mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first),
+                                               _mm_cmpeq_epi8(b, tail)));
+
+        while (mask != 0) {
+            n = nxt_trailing_zeros(mask);
+
+            if (memcmp(p + n + 1, ss + 1, length - 2) == 0) {
+                return p + n;
+            }
+
+            mask &= mask - 1;
+
+            if (bounded
+                && ++candidates * length > (size_t) (p - start) + 16 * length)
+            {
+                goto done;
+            }
+        }
+
+        p += 16;
+    }
+
+done:
+
+    *pos = p;
+
+    return NULL;
+}
+
+#endif
+
+
+const u_char *
+nxt_memrstr(const u_char *start, const u_char *end, const u_char *ss,
+    size_t length)
+{
+    const u_char  *p;
+
+#if (NXT_HAVE_SSE2)
+    uint32_t      n, mask;
+    __m128i       first, tail, a, b;
+#endif
+
+    if (length == 0) {
+        return end;
+    }
+
+    if ((size_t) (end - start) < length) {
+        return NULL;
+    }
+
+    /* The last position the string can start at. */
+    p = end - length;
+
+#if (NXT_HAVE_SSE2)
+
+    if (length > 1) {
+        first = _mm_set1_epi8(ss[0]);
+        tail = _mm_set1_epi8(ss[length - 1]);
+
+        while (p - start >= 16) {
+            p -= 15;
+
+            a = _mm_loadu_si128((const __m128i *) p);
+            b = _mm_loadu_si128((const __m128i *) (p + length - 1));
+
+            mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first),
+                                                   _mm_cmpeq_epi8(b, tail)));
+
+            while (mask != 0) {
+                n = 31 - nxt_leading_zeros(mask);
+
+                if (memcmp(p + n + 1, ss + 1, length - 2) == 0) {
+                    return p + n;
+                }
+
+                mask &= ~(1U << n);
+            }
+
+            p--;
+        }
+    }
+
+#endif
+
+    for ( ;; ) {
+        if (p[0] == ss[0] && memcmp(p + 1, ss + 1, length - 1) == 0) {
+            return p;
+        }
+
+        if (p == start) {
+            return NULL;
+        }
+
+        p--;
+    }
+}
+
+
+/*
+ * The Crochemore-Perrin two-way string matching.  The string is split
+ * at its critical position, the right part is compared left to right
+ * and then the left part is compared right to left.  A mismatch in the
+ * right part shifts the string past the mismatched byte, a mismatch in
+ * the left part shifts it by the period.  For periodic strings the
+ * "memory" of the already matched prefix prevents comparing it again,
+ * so the search is linear in the worst case and uses constant space.
+ * Besides, the byte under the last position of the string is tested
+ * first as in the Boyer-Moore-Horspool search, so on a typical text
+ * the search skips several bytes at once.
+ *
+ * The SSE2 filter of nxt_memstr() is still faster on a typical text,
+ * so the search starts with the filter and switches to the two-way
+ * search only if candidate positions are too frequent.
+ *
+ * The preparation costs more than nxt_memstr() search in a short text,
+ * so it is intended for long strings searched in long texts, and the
+ * prepared search can be reused.  The string should not be empty.
+ */
+
+static size_t
+nxt_twoway_maximal_suffix(const u_char *ss, size_t length, size_t *period,
+    nxt_bool_t reverse)
+{
+    u_char  a, b;
+    size_t  i, j, k, p;
+
+    /* "i" is the start of the suffix minus one, it starts with (size_t) -1. */
+
+    i = (size_t) -1;
+    j = 0;
+    k = 1;
+    p = 1;
+
+    while (j + k < length) {
+        a = ss[i + k];
+        b = ss[j + k];
+
+        if (a == b) {
+            if (k == p) {
+                j += p;
+                k = 1;
+
+            } else {
+                k++;
+            }
+
+        } else if ((a > b) ^ reverse) {
+            j += k;
+            k = 1;
+            p = j - i;
+
+        } else {
+            i = j++;
+            k = 1;
+            p = 1;
+        }
+    }
+
+    *period = p;
+
+    return i;
+}
+
+
+void
+nxt_twoway_init(nxt_twoway_t *tw, const u_char *ss, size_t length)
+{
+    size_t  i, critical, critical2, period, period2;
+
+    tw->start = ss;
+    tw->length = length;
+
+    nxt_memzero(tw->shift, sizeof(tw->shift));
+
+    for (i = 0; i < length; i++) {
+        tw->shift[ss[i]] = i + 1;
+    }
+
+    critical = nxt_twoway_maximal_suffix(ss, length, &period, 0);
+    critical2 = nxt_twoway_maximal_suffix(ss, length, &period2, 1);
+
+    if (critical2 + 1 > critical + 1) {
+        critical = critical2;
+        period = period2;
+    }
+
+    /* "critical" is the last position of the left part or (size_t) -1. */
+
+    tw->critical = critical + 1;
+
+    if (memcmp(ss, ss + period, critical + 1) == 0) {
+        tw->period = period;
+        tw->memory = length - period;
+
+    } else {
+        tw->period = nxt_max(critical, length - critical - 1) + 1;
+        tw->memory = 0;
+    }
+}
+
+
+const u_char *
+nxt_twoway_search(const nxt_twoway_t *tw, const u_char *start,
+    const u_char *end)
+{
+    size_t        k, shift, memory, length, critical;
+    const u_char  *p, *ss;
+
+    ss = tw->start;
+    length = tw->length;
+    critical = tw->critical;
+
+    p = start;
+
+#if (NXT_HAVE_SSE2)
+
+    if (length > 1 && (size_t) (end - p) >= length) {
+        start = nxt_memstr_sse2(&p, end - length, ss, length, 1);
+
+        if (start != NULL) {
+            return start;
+        }
+    }
+
+#endif
+
+    memory = 0;
+
+    while ((size_t) (end - p) >= length) {
+
+        shift = tw->shift[p[length - 1]];
+
+        if (shift != length) {
+            /* The last byte does not match. */
+
+            k = length - shift;
+
+            if (k < memory) {
+                k = memory;
+            }
+
+            p += k;
+            memory = 0;
+            continue;
+        }
+
+        /* The right part. */
+
+        for (k = nxt_max(critical, memory); k < length; k++) {
+            if (ss[k] != p[k]) {
+                break;
+            }
+        }
+
+        if (k < length) {
+            p += k - critical + 1;
+            memory = 0;
+            continue;
+        }
+
+        /* The left part. */
+
+        for (k = critical; k > memory; k--) {
+            if (ss[k - 1] != p[k - 1]) {
+                break;
+            }
+        }
+
+        if (k <= memory) {
+            return p;
+        }
+
+        p += tw->period;
+        memory = tw->memory;
+    }
+
+    return NULL;
+}
+
+
+/*
+ * nxt_ascii_lower_case() and nxt_ascii_upper_case() copy ASCII characters
+ * from src to dst changing their case up to the first non-ASCII byte and
+ * return the number of copied bytes.  The characters are converted by 16
+ * bytes at once with SSE2 or by the size of uint64_t otherwise: the case
+ * bit 0x20 is flipped in bytes which are in the range of the letters.
+ */
+
+size_t
+nxt_ascii_lower_case(u_char *dst, const u_char *src, size_t size)
+{
+    return nxt_ascii_case(dst, src, size, 'A', 'Z');
+}
+
+
+size_t
+nxt_ascii_upper_case(u_char *dst, const u_char *src, size_t size)
+{
+    return nxt_ascii_case(dst, src, size, 'a', 'z');
+}
+
+
+static size_t
+nxt_ascii_case(u_char *dst, const u_char *src, size_t size, u_char first,
+    u_char last)
+{
+    u_char        c;
+    const u_char  *p, *end;
+
+#if (NXT_HAVE_SSE2)
+    __m128i       a, lo, hi, bit;
+
+    lo = _mm_set1_epi8(first - 1);
+    hi = _mm_set1_epi8(last + 1);
+    bit = _mm_set1_epi8(0x20);
+#else
+    uint64_t      word, ge, gt;
+
+    const uint64_t  ones = 0x0101010101010101ULL;
+#endif
+
+    p = src;
+    end = src + size;
+
+#if (NXT_HAVE_SSE2)
+
+    while (end - p >= 16) {
+        a = _mm_loadu_si128((const __m128i *) p);
+
+        if (_mm_movemask_epi8(a) != 0) {
+            break;
+        }
+
+        /* ASCII bytes are positive as signed ones. */
+
+        a = _mm_xor_si128(a, _mm_and_si128(bit,
+                                 _mm_and_si128(_mm_cmpgt_epi8(a, lo),
+                                               _mm_cmplt_epi8(a, hi))));
+
+        _mm_storeu_si128((__m128i *) dst, a);
+
+        p += 16;
+        dst += 16;
+    }
+
+#else
+
+    while ((size_t) (end - p) >= sizeof(uint64_t)) {
+        memcpy(&word, p, sizeof(uint64_t));
+
+        if ((word & (ones * 0x80)) != 0) {
+            break;
+        }
+
+        /*
+         * The high bit of a byte is set if the byte is greater than
+         * or equal to "first" and greater than "last" respectively.
+         * The sums do not overflow bytes since all bytes are ASCII.
+         */
+
+        ge = word + ones * (0x80 - first);
+        gt = word + ones * (0x80 - last - 1);
+
+        word ^= ((ge ^ gt) & (ones * 0x80)) >> 2;
+
+        memcpy(dst, &word, sizeof(uint64_t));
+
+        p += sizeof(uint64_t);
+        dst += sizeof(uint64_t);
+    }
+
+#endif
+
+    while (p < end) {
+        c = *p;
+
+        if (c >= 0x80) {
+            break;
+        }
+
+        *dst++ = (c >= first && c <= last) ? c ^ 0x20 : c;
+        p++;
+    }
+
+    return p - src;
+}
@@ -75,4 +75,29 @@ nxt_explicit_memzero(u_char *buf, size_t length)
      && (memcmp((s1)->start, (s2)->start, (s1)->length) == 0))
 
 
+typedef struct {
+    const u_char  *start;
+    size_t        length;
+    size_t        period;
+    size_t        critical;
+    size_t        memory;
+    /* The position after the last occurrence of a byte in the string. */
+    size_t        shift[256];
+} nxt_twoway_t;
+
+
+NXT_EXPORT const u_char *nxt_memstr(const u_char *start, const u_char *end,
+    const u_char *ss, size_t length);
+NXT_EXPORT const u_char *nxt_memrstr(const u_char *start, const u_char *end,
+    const u_char *ss, size_t length);
+NXT_EXPORT void nxt_twoway_init(nxt_twoway_t *tw, const u_char *ss,
+    size_t length);
+NXT_EXPORT const u_char *nxt_twoway_search(const nxt_twoway_t *tw,
+    const u_char *start, const u_char *end);
+NXT_EXPORT size_t nxt_ascii_lower_case(u_char *dst, const u_char *src,
+    size_t size);
+NXT_EXPORT size_t nxt_ascii_upper_case(u_char *dst, const u_char *src,
+    size_t size);
+
+
 #endif /* _NXT_STRING_H_INCLUDED_ */
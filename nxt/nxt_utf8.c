@@ -8,6 +8,7 @@
 #include <nxt_types.h>
 #include <nxt_clang.h>
 #include <nxt_utf8.h>
+#include <string.h>
 
 /*
  * The nxt_unicode_lower_case.h and nxt_unicode_upper_case.h files are
@@ -24,6 +25,13 @@
 #include <nxt_unicode_lower_case.h>
 #include <nxt_unicode_upper_case.h>
 
+#if (NXT_HAVE_SSE2)
+#include <emmintrin.h>
+#endif
+
+
+static const u_char *nxt_utf8_ascii(const u_char *p, const u_char *end);
+
 
 u_char *
 nxt_utf8_encode(u_char *p, uint32_t u)
@@ -257,22 +265,97 @@ nxt_utf8_upper_case(const u_char **start, const u_char *end)
 }
 
 
+/*
+ * nxt_utf8_ascii() returns the end of ASCII characters starting at p.
+ * The characters are tested by 16 bytes at once with SSE2 or by the size
+ * of uint64_t otherwise.
+ */
+
+static const u_char *
+nxt_utf8_ascii(const u_char *p, const u_char *end)
+{
+#if (NXT_HAVE_SSE2)
+    uint32_t  mask;
+
+    while (end - p >= 16) {
+        mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) p));
+
+        if (mask != 0) {
+            return p + nxt_trailing_zeros(mask);
+        }
+
+        p += 16;
+    }
+
+#else
+    uint64_t  word;
+
+    while ((size_t) (end - p) >= sizeof(uint64_t)) {
+        memcpy(&word, p, sizeof(uint64_t));
+
+        if ((word & 0x8080808080808080ULL) != 0) {
+            break;
+        }
+
+        p += sizeof(uint64_t);
+    }
+
+#endif
+
+    while (p < end && *p < 0x80) {
+        p++;
+    }
+
+    return p;
+}
+
+
+/*
+ * Strings are mostly either ASCII or consist of two or three bytes
+ * sequences with ASCII spaces and punctuation, so nxt_utf8_length()
+ * skips ASCII characters by blocks and tests the most frequent two and
+ * three bytes sequences in place.
+ */
+
 ssize_t
 nxt_utf8_length(const u_char *p, size_t len)
 {
+    u_char        c;
     ssize_t       length;
-    const u_char  *end;
+    const u_char  *end, *ascii;
 
     length = 0;
 
     end = p + len;
 
     while (p < end) {
-        if (nxt_slow_path(nxt_utf8_decode(&p, end) == 0xffffffff)) {
-            return -1;
-        }
+        ascii = nxt_utf8_ascii(p, end);
+
+        length += ascii - p;
+        p = ascii;
+
+        while (p < end && *p >= 0x80) {
+            c = *p;
+
+            if (c >= 0xC2 && c < 0xE0
+                && end - p > 1 && (p[1] & 0xC0) == 0x80)
+            {
+                p += 2;
 
-        length++;
+            } else if (c >= 0xE1 && c < 0xF0
+                       && end - p > 2 && (p[1] & 0xC0) == 0x80
+                       && (p[2] & 0xC0) == 0x80)
+            {
+                /* Sequences starting with 0xE1 - 0xEF are not overlong. */
+                p += 3;
+
+            } else if (nxt_slow_path(nxt_utf8_decode2(&p, end) == 0xffffffff))
+            {
+                return -1;
+            }
+
+            length++;
+        }
     }
 
     return length;
@@ -282,15 +365,5 @@ nxt_utf8_length(const u_char *p, size_t len)
 nxt_bool_t
 nxt_utf8_is_valid(const u_char *p, size_t len)
 {
-    const u_char  *end;
-
-    end = p + len;
-
-    while (p < end) {
-        if (nxt_slow_path(nxt_utf8_decode(&p, end) == 0xffffffff)) {
-            return 0;
-        }
-    }
-
-    return 1;
+    return (nxt_utf8_length(p, len) >= 0);
 }
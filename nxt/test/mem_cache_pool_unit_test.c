@@ -0,0 +1,387 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_auto_config.h>
+#include <nxt_types.h>
+#include <nxt_clang.h>
+#include <nxt_string.h>
+#include <nxt_stub.h>
+#include <nxt_malloc.h>
+#include <nxt_murmur_hash.h>
+#include <nxt_mem_cache_pool.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/resource.h>
+
+
+typedef struct {
+    u_char      *p;
+    uint32_t    size;
+} mem_cache_pool_unit_test_item_t;
+
+
+static void *
+mem_cache_pool_malloc(void *mem, size_t size)
+{
+    return nxt_malloc(size);
+}
+
+
+static void *
+mem_cache_pool_zalloc(void *mem, size_t size)
+{
+    void  *p;
+
+    p = nxt_malloc(size);
+
+    if (p != NULL) {
+        nxt_memzero(p, size);
+    }
+
+    return p;
+}
+
+
+static void *
+mem_cache_pool_align(void *mem, size_t alignment, size_t size)
+{
+    return nxt_memalign(alignment, size);
+}
+
+
+static void
+mem_cache_pool_free(void *mem, void *p)
+{
+    nxt_free(p);
+}
+
+
+static void
+mem_cache_pool_alert(void *mem, const char *fmt, ...)
+{
+    int      n;
+    va_list  args;
+    char     buf[1024];
+
+    va_start(args, fmt);
+    n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    (void) printf("alert: \"%.*s\"\n", n, buf);
+}
+
+
+static const nxt_mem_proto_t  mem_cache_pool_proto = {
+    mem_cache_pool_malloc,
+    mem_cache_pool_zalloc,
+    mem_cache_pool_align,
+    NULL,
+    mem_cache_pool_free,
+    mem_cache_pool_alert,
+    NULL,
+};
+
+
+static nxt_int_t
+mem_cache_pool_unit_test_check(mem_cache_pool_unit_test_item_t *item)
+{
+    if (item->p[0] != (u_char) item->size
+        || item->p[item->size - 1] != (u_char) item->size)
+    {
+        printf("mem cache pool unit test failed: %p of size %u is corrupted\n",
+               item->p, item->size);
+        return NXT_ERROR;
+    }
+
+    return NXT_OK;
+}
+
+
+/*
+ * The test allocates and frees chunks of mixed sizes in random order,
+ * most of them are small as allocations of a VM are.  The first and
+ * the last bytes of allocations are tested before free to detect
+ * overlapped allocations.
+ */
+
+static nxt_int_t
+mem_cache_pool_unit_test(nxt_uint_t n, nxt_uint_t live)
+{
+    uint32_t                         key, size;
+    uint64_t                         us;
+    nxt_int_t                        ret;
+    nxt_uint_t                       i;
+    struct rusage                    usage;
+    nxt_mem_cache_pool_t             *pool;
+    mem_cache_pool_unit_test_item_t  *items, *item;
+
+    const size_t                     min_chunk_size = 16;
+    const size_t                     page_size = 512;
+    const size_t                     page_alignment = 128;
+    const size_t                     cluster_size = 8192;
+
+    printf("mem cache pool unit test started: %ld operations, "
+           "%ld live allocations\n", (long) n, (long) live);
+
+    ret = NXT_ERROR;
+
+    items = nxt_malloc(live * sizeof(mem_cache_pool_unit_test_item_t));
+    if (items == NULL) {
+        return NXT_ERROR;
+    }
+
+    nxt_memzero(items, live * sizeof(mem_cache_pool_unit_test_item_t));
+
+    pool = nxt_mem_cache_pool_create(&mem_cache_pool_proto, NULL, NULL,
+                                     cluster_size, page_alignment,
+                                     page_size, min_chunk_size);
+    if (pool == NULL) {
+        goto fail;
+    }
+
+    key = 0;
+
+    for (i = 0; i < n; i++) {
+        key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+
+        item = &items[key % live];
+
+        if (item->p != NULL) {
+            if (mem_cache_pool_unit_test_check(item) != NXT_OK) {
+                goto fail;
+            }
+
+            nxt_mem_cache_free(pool, item->p);
+            item->p = NULL;
+
+            continue;
+        }
+
+        /* One of 16 allocations is larger than a page. */
+
+        if ((key >> 8) % 16 == 0) {
+            size = page_size + (key >> 12) % (4 * page_size);
+
+        } else {
+            size = 1 + (key >> 12) % (page_size / 2);
+        }
+
+        item->p = nxt_mem_cache_alloc(pool, size);
+        if (item->p == NULL) {
+            printf("mem cache pool unit test failed: "
+                   "allocation of %u failed\n", size);
+            goto fail;
+        }
+
+        item->size = size;
+        item->p[0] = (u_char) size;
+        item->p[size - 1] = (u_char) size;
+    }
+
+    for (i = 0; i < live; i++) {
+        item = &items[i];
+
+        if (item->p != NULL) {
+            if (mem_cache_pool_unit_test_check(item) != NXT_OK) {
+                goto fail;
+            }
+
+            nxt_mem_cache_free(pool, item->p);
+        }
+    }
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    us = usage.ru_utime.tv_sec * 1000000 + usage.ru_utime.tv_usec
+         + usage.ru_stime.tv_sec * 1000000 + usage.ru_stime.tv_usec;
+
+    if (!nxt_mem_cache_pool_is_empty(pool)) {
+        printf("mem cache pool unit test failed: pool is not empty\n");
+        goto fail;
+    }
+
+    printf("mem cache pool unit test passed: %.3fns per operation\n",
+           (double) us * 1000 / n);
+
+    ret = NXT_OK;
+
+fail:
+
+    if (pool != NULL) {
+        nxt_mem_cache_pool_destroy(pool);
+    }
+
+    nxt_free(items);
+
+    return ret;
+}
+
+
+/*
+ * The test creates and destroys short-lived pools to exercise clusters
+ * and pools reused from the thread cache.  The reused memory must be
+ * indistinguishable from the fresh one.
+ */
+
+static nxt_int_t
+mem_cache_pool_reuse_unit_test(nxt_uint_t n)
+{
+    u_char                *p[64];
+    uint64_t              us;
+    nxt_uint_t            i, k;
+    struct rusage         start, end;
+    nxt_mem_cache_pool_t  *pool;
+
+    printf("mem cache pool reuse unit test started: %ld pools\n", (long) n);
+
+    getrusage(RUSAGE_SELF, &start);
+
+    for (i = 0; i < n; i++) {
+        pool = nxt_mem_cache_pool_create(&mem_cache_pool_proto, NULL, NULL,
+                                         8192, 128, 512, 16);
+        if (pool == NULL) {
+            return NXT_ERROR;
+        }
+
+        for (k = 0; k < 64; k++) {
+            p[k] = nxt_mem_cache_alloc(pool, 16 + k * 4);
+            if (p[k] == NULL) {
+                printf("mem cache pool reuse unit test failed: "
+                       "allocation failed\n");
+                return NXT_ERROR;
+            }
+
+            nxt_memset(p[k], (u_char) k, 16 + k * 4);
+        }
+
+        for (k = 0; k < 64; k++) {
+            if (p[k][0] != (u_char) k || p[k][15 + k * 4] != (u_char) k) {
+                printf("mem cache pool reuse unit test failed: "
+                       "%p is corrupted\n", p[k]);
+                return NXT_ERROR;
+            }
+
+            if (k % 2 == 0) {
+                nxt_mem_cache_free(pool, p[k]);
+            }
+        }
+
+        nxt_mem_cache_pool_destroy(pool);
+    }
+
+    getrusage(RUSAGE_SELF, &end);
+
+    nxt_mem_cache_pool_thread_cache_flush();
+
+    us = (end.ru_utime.tv_sec - start.ru_utime.tv_sec) * 1000000
+         + end.ru_utime.tv_usec - start.ru_utime.tv_usec
+         + (end.ru_stime.tv_sec - start.ru_stime.tv_sec) * 1000000
+         + end.ru_stime.tv_usec - start.ru_stime.tv_usec;
+
+    printf("mem cache pool reuse unit test passed: %.3fns per pool\n",
+           (double) us * 1000 / n);
+
+    return NXT_OK;
+}
+
+
+/*
+ * The test fills many regions of an arena pool with allocations of odd
+ * sizes, so the aligned start of the next allocation often does not fit
+ * in the rest of the region.
+ */
+
+static nxt_int_t
+mem_cache_pool_arena_unit_test(nxt_uint_t n)
+{
+    uint32_t                         key, size;
+    nxt_int_t                        ret;
+    nxt_uint_t                       i;
+    nxt_mem_cache_pool_t             *pool;
+    mem_cache_pool_unit_test_item_t  *items, *item;
+
+    printf("mem cache pool arena unit test started: %ld allocations\n",
+           (long) n);
+
+    ret = NXT_ERROR;
+
+    items = nxt_malloc(n * sizeof(mem_cache_pool_unit_test_item_t));
+    if (items == NULL) {
+        return NXT_ERROR;
+    }
+
+    pool = nxt_mem_cache_pool_arena_create(&mem_cache_pool_proto, NULL, NULL,
+                                           4096);
+    if (pool == NULL) {
+        goto fail;
+    }
+
+    key = 0;
+
+    for (i = 0; i < n; i++) {
+        key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+
+        size = 1 + (key >> 8) % 255;
+
+        item = &items[i];
+
+        if (key % 8 == 0) {
+            item->p = nxt_mem_cache_align(pool, 64, size);
+
+        } else {
+            item->p = nxt_mem_cache_alloc(pool, size);
+        }
+
+        if (item->p == NULL) {
+            printf("mem cache pool arena unit test failed: "
+                   "allocation of %u failed\n", size);
+            goto fail;
+        }
+
+        item->size = size;
+        nxt_memset(item->p, (u_char) size, size);
+    }
+
+    for (i = 0; i < n; i++) {
+        if (mem_cache_pool_unit_test_check(&items[i]) != NXT_OK) {
+            goto fail;
+        }
+    }
+
+    printf("mem cache pool arena unit test passed\n");
+
+    ret = NXT_OK;
+
+fail:
+
+    if (pool != NULL) {
+        nxt_mem_cache_pool_destroy(pool);
+    }
+
+    nxt_free(items);
+
+    return ret;
+}
+
+
+int
+main(void)
+{
+    if (mem_cache_pool_unit_test(10 * 1000 * 1000, 4096) != NXT_OK) {
+        return 1;
+    }
+
+    if (mem_cache_pool_reuse_unit_test(1000 * 1000) != NXT_OK) {
+        return 1;
+    }
+
+    if (mem_cache_pool_arena_unit_test(100 * 1000) != NXT_OK) {
+        return 1;
+    }
+
+    return 0;
+}
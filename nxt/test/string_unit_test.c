@@ -0,0 +1,200 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_auto_config.h>
+#include <nxt_types.h>
+#include <nxt_clang.h>
+#include <nxt_string.h>
+#include <nxt_stub.h>
+#include <nxt_murmur_hash.h>
+#include <stdio.h>
+#include <string.h>
+
+
+static const u_char *
+string_unit_test_memstr(const u_char *start, const u_char *end,
+    const u_char *ss, size_t length)
+{
+    const u_char  *p;
+
+    for (p = start; p + length <= end; p++) {
+        if (memcmp(p, ss, length) == 0) {
+            return p;
+        }
+    }
+
+    return NULL;
+}
+
+
+static const u_char *
+string_unit_test_memrstr(const u_char *start, const u_char *end,
+    const u_char *ss, size_t length)
+{
+    const u_char  *p;
+
+    if ((size_t) (end - start) < length) {
+        return NULL;
+    }
+
+    for (p = end - length; /* void */; p--) {
+        if (memcmp(p, ss, length) == 0) {
+            return p;
+        }
+
+        if (p == start) {
+            return NULL;
+        }
+    }
+}
+
+
+/*
+ * The test compares results of nxt_memstr(), nxt_memrstr(), and
+ * nxt_twoway_search() with results of the naive search in random strings
+ * of a small alphabet, so there are many partial matches.  The search
+ * strings are either random or taken from the searched string.
+ */
+
+static nxt_int_t
+string_unit_test(nxt_uint_t n)
+{
+    u_char        buf[256], ss[64];
+    uint32_t      key;
+    nxt_uint_t    i, k, size, length, offset;
+    nxt_twoway_t  tw;
+    const u_char  *start, *end, *p1, *p2, *p3, *p4, *p5;
+
+    printf("string unit test started: %ld searches\n", (long) n);
+
+    key = 0;
+
+    for (i = 0; i < n; i++) {
+        key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+
+        size = key % sizeof(buf);
+        length = (key >> 8) % (sizeof(ss) / ((key >> 20) % 4 + 1));
+
+        for (k = 0; k < size; k++) {
+            key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+            buf[k] = 'a' + key % 3;
+        }
+
+        if (length <= size && (key >> 16) % 2 == 0) {
+            offset = (key >> 4) % (size - length + 1);
+            memcpy(ss, &buf[offset], length);
+
+        } else {
+            for (k = 0; k < length; k++) {
+                key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+                ss[k] = 'a' + key % 3;
+            }
+        }
+
+        offset = (size != 0) ? (key >> 12) % size : 0;
+
+        start = buf + offset;
+        end = buf + size;
+
+        p1 = nxt_memstr(start, end, ss, length);
+        p2 = string_unit_test_memstr(start, end, ss, length);
+
+        p3 = nxt_memrstr(buf, start, ss, length);
+        p4 = string_unit_test_memrstr(buf, start, ss, length);
+
+        p5 = p2;
+
+        if (length != 0) {
+            nxt_twoway_init(&tw, ss, length);
+            p5 = nxt_twoway_search(&tw, start, end);
+        }
+
+        if (p1 != p2 || p3 != p4 || p5 != p2) {
+            printf("string unit test failed: \"%.*s\" in \"%.*s\"\n",
+                   (int) length, ss, (int) size, buf);
+            return NXT_ERROR;
+        }
+    }
+
+    printf("string unit test passed\n");
+
+    return NXT_OK;
+}
+
+
+/*
+ * The test compares results of nxt_ascii_lower_case() and
+ * nxt_ascii_upper_case() with results of nxt_lower_case() and
+ * nxt_upper_case() in random strings which are mostly ASCII.
+ */
+
+static nxt_int_t
+string_case_unit_test(nxt_uint_t n)
+{
+    u_char      buf[256], lower[256], upper[256];
+    uint32_t    key;
+    nxt_uint_t  i, k, size, ascii, n1, n2;
+
+    printf("string case unit test started: %ld strings\n", (long) n);
+
+    key = 0;
+
+    for (i = 0; i < n; i++) {
+        key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+
+        size = key % sizeof(buf);
+        ascii = size;
+
+        for (k = 0; k < size; k++) {
+            key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+
+            /* One of 64 bytes is not ASCII. */
+            buf[k] = (key % 64 == 0) ? 0x80 | (key >> 8) : (key >> 8) % 0x80;
+
+            if (buf[k] >= 0x80 && ascii == size) {
+                ascii = k;
+            }
+        }
+
+        n1 = nxt_ascii_lower_case(lower, buf, size);
+        n2 = nxt_ascii_upper_case(upper, buf, size);
+
+        if (n1 != ascii || n2 != ascii) {
+            printf("string case unit test failed: %ld, %ld instead of %ld\n",
+                   (long) n1, (long) n2, (long) ascii);
+            return NXT_ERROR;
+        }
+
+        for (k = 0; k < ascii; k++) {
+            if (lower[k] != nxt_lower_case(buf[k])
+                || upper[k] != nxt_upper_case(buf[k]))
+            {
+                printf("string case unit test failed: \"%.*s\"\n",
+                       (int) size, buf);
+                return NXT_ERROR;
+            }
+        }
+    }
+
+    printf("string case unit test passed\n");
+
+    return NXT_OK;
+}
+
+
+int
+main(void)
+{
+    if (string_unit_test(1000 * 1000) != NXT_OK) {
+        return 1;
+    }
+
+    if (string_case_unit_test(100 * 1000) != NXT_OK) {
+        return 1;
+    }
+
+    return 0;
+}
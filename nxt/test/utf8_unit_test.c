@@ -10,6 +10,7 @@
 #include <nxt_string.h>
 #include <nxt_stub.h>
 #include <nxt_utf8.h>
+#include <nxt_murmur_hash.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -191,6 +192,84 @@ utf8_unit_test(nxt_uint_t start)
 }
 
 
+static ssize_t
+utf8_length(const u_char *p, size_t len)
+{
+    ssize_t       length;
+    const u_char  *end;
+
+    length = 0;
+    end = p + len;
+
+    while (p < end) {
+        if (nxt_utf8_decode(&p, end) == 0xFFFFFFFF) {
+            return -1;
+        }
+
+        length++;
+    }
+
+    return length;
+}
+
+
+/*
+ * The test compares nxt_utf8_length() with decoding character by
+ * character on random mixes of ASCII, two, three, and four bytes
+ * characters with occasional invalid bytes at random positions.
+ */
+
+static nxt_int_t
+utf8_length_unit_test(nxt_uint_t n)
+{
+    u_char      *p, *end, buf[256];
+    size_t      size;
+    ssize_t     length, expected;
+    uint32_t    key, u;
+    nxt_uint_t  i;
+
+    static const uint32_t  chars[] = { 'a', ' ', 0x0431, 0x03B1, 0x4E2D,
+                                       0xFFFD, 0x1F600, 0x10FFFF };
+
+    printf("utf8 length unit test started: %ld strings\n", (long) n);
+
+    key = 0;
+
+    for (i = 0; i < n; i++) {
+        key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+
+        p = buf;
+        end = buf + (key % (sizeof(buf) - 4));
+
+        while (p < end) {
+            key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+            u = chars[key % (((key >> 8) % 2 == 0) ? 2 : 8)];
+            p = nxt_utf8_encode(p, u);
+        }
+
+        size = p - buf;
+
+        if (size != 0 && (key >> 16) % 8 == 0) {
+            buf[(key >> 4) % size] = 0x80 + (key >> 24) % 0x80;
+        }
+
+        length = nxt_utf8_length(buf, size);
+        expected = utf8_length(buf, size);
+
+        if (length != expected
+            || nxt_utf8_is_valid(buf, size) != (expected >= 0))
+        {
+            printf("nxt_utf8_length(\"%.*s\") failed: %zd, expected %zd\n",
+                   (int) size, buf, length, expected);
+            return NXT_ERROR;
+        }
+    }
+
+    printf("utf8 length unit test passed\n");
+    return NXT_OK;
+}
+
+
 int
 main(int argc, char **argv)
 {
@@ -203,5 +282,13 @@ main(int argc, char **argv)
         start = 256;
     }
 
-    return utf8_unit_test(start);
+    if (utf8_unit_test(start) != NXT_OK) {
+        return 1;
+    }
+
+    if (utf8_length_unit_test(100 * 1000) != NXT_OK) {
+        return 1;
+    }
+
+    return 0;
 }